@@ -0,0 +1,177 @@
+#include "barrett.hpp"
+
+#include <stdexcept>
+
+#include "instrument.hpp"
+#include "limb_ops.hpp"
+
+// --- constructors ---
+
+template <uint16_t Bits>
+BarrettContext<Bits>::BarrettContext(const uint_t<Bits>& modulus){
+	uint64_t power[2u * uint_t<Bits>::Limbs + 1u];
+	uint64_t remainder[uint_t<Bits>::Limbs];
+
+	if (modulus == 0ull) throw std::invalid_argument("BarrettContext: modulus must not be zero");
+
+	modulus_ = modulus;
+	size_ = modulus.num_limbs();
+
+	// mu = 2^(128k) / m, a 2k + 1 limb dividend gives a k + 2 limb quotient
+	limbs_zero(power, 2u * size_);
+	power[2u * size_] = 1ull;
+	limbs_divmod(mu_, remainder, power, 2u * size_ + 1u, modulus_.parts_, size_);
+
+	mu_size_ = size_ + 2u;
+	while (!mu_[mu_size_ - 1u]) --mu_size_;
+}
+
+// --- functions ---
+
+template <uint16_t Bits>
+void BarrettContext<Bits>::reduce_limbs(const uint64_t* x, uint16_t n, uint64_t* r) const{
+	uint64_t q2[2u * uint_t<Bits>::Limbs + 4u];
+	uint64_t q3_m[uint_t<Bits>::Limbs + 1u];
+	uint64_t rem[uint_t<Bits>::Limbs + 1u];
+	uint16_t k, size_q1, size_q3, size_low;
+	const uint64_t *q1, *q3;
+
+	k = size_;
+	while (n && !x[n - 1u]) --n;
+
+	// below 2^(64(k - 1)) x is already less than m
+	if (n < k){
+		limbs_copy(r, x, n);
+		limbs_zero(r + n, k - n);
+		return;
+	}
+
+	/*
+	q3 = ((x / 2^(64(k - 1))) * mu) / 2^(64(k + 1)) is at most 2 less
+	than x / m, and only needs the top limbs of x.
+	the columns of q1 * mu below k - 1 can only carry 1 into the part that
+	is kept, so they are left out. q3 is then at most 3 less than x / m
+	*/
+	q1 = x + (k - 1u);
+	size_q1 = n - (k - 1u);
+	limbs_zero(q2, size_q1 + mu_size_);
+	for (auto i = 0u; i < size_q1; ++i){
+		uint16_t skip = (i + 1u < k) ? k - 1u - i : 0u;
+
+		if (skip >= mu_size_) continue;
+		q2[i + mu_size_] = limbs_addmul_1(q2 + i + skip, mu_ + skip, mu_size_ - skip, q1[i]);
+	}
+	size_q3 = (size_q1 + mu_size_ > k + 1u) ? size_q1 + mu_size_ - (k + 1u) : 0u;
+	q3 = q2 + (k + 1u);
+	while (size_q3 && !q3[size_q3 - 1u]) --size_q3;
+
+	/*
+	x - q3 * m is less than 4m, so the low k + 1 limbs of both are enough.
+	the rows of q3 * m are cut off at limb k + 1 as well
+	*/
+	size_low = (n < k + 1u) ? n : k + 1u;
+	limbs_copy(rem, x, size_low);
+	limbs_zero(rem + size_low, k + 1u - size_low);
+
+	limbs_zero(q3_m, k + 1u);
+	for (auto i = 0u; i < size_q3 && i < k + 1u; ++i){
+		uint16_t length = (i == 0u) ? k : k + 1u - i;
+		auto carry = limbs_addmul_1(q3_m + i, modulus_.parts_, length, q3[i]);
+
+		if (i == 0u) q3_m[k] = carry;
+	}
+	limbs_sub(rem, rem, k + 1u, q3_m, k + 1u);
+
+	// at most three subtractions
+	while (rem[k] || limbs_cmp(rem, modulus_.parts_, k) >= 0)
+		limbs_sub(rem, rem, k + 1u, modulus_.parts_, k);
+
+	limbs_copy(r, rem, k);
+}
+
+template <uint16_t Bits>
+void BarrettContext<Bits>::reduce_any(const uint64_t* x, uint16_t n, uint64_t* r) const{
+	uint64_t window[2u * uint_t<Bits>::Limbs];
+	uint16_t k, length, position;
+
+	k = size_;
+	if (n <= 2u * k){
+		reduce_limbs(x, n, r);
+		return;
+	}
+
+	/*
+	r * 2^(64k) + the next k limbs is below m * 2^(64k) < 2^(128k), so it
+	can be reduced in one step. the first window only holds the limbs
+	left over at the top
+	*/
+	limbs_zero(r, k);
+	length = (n % k) ? n % k : k;
+	position = n - length;
+	for (;;){
+		limbs_copy(window, x + position, length);
+		limbs_zero(window + length, k - length);
+		limbs_copy(window + k, r, k);
+		reduce_limbs(window, 2u * k, r);
+
+		if (!position) break;
+		position -= k;
+		length = k;
+	}
+}
+
+template <uint16_t Bits>
+uint_t<Bits> BarrettContext<Bits>::reduce(const uint_t<Bits>& x) const{
+	BIGNUM_INSTRUMENT_SCOPE(barrett, x.size_);
+
+	uint_t<Bits> ret;
+
+	reduce_any(x.parts_, x.size_, ret.parts_);
+	ret.trim(size_);
+	return ret;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> BarrettContext<Bits>::mul_mod(const uint_t<Bits>& a, const uint_t<Bits>& b) const{
+	BIGNUM_INSTRUMENT_SCOPE(barrett, a.size_ + b.size_);
+
+	uint64_t product[2u * uint_t<Bits>::Limbs];
+	uint_t<Bits> ret;
+	uint16_t size_a, size_b;
+
+	size_a = a.size_;
+	size_b = b.size_;
+	if (!size_a || !size_b) return ret;
+
+	limbs_mul(product, a.parts_, size_a, b.parts_, size_b);
+	reduce_any(product, size_a + size_b, ret.parts_);
+	ret.trim(size_);
+	return ret;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> BarrettContext<Bits>::sqr_mod(const uint_t<Bits>& a) const{
+	BIGNUM_INSTRUMENT_SCOPE(barrett, a.size_);
+
+	uint64_t square[2u * uint_t<Bits>::Limbs];
+	uint_t<Bits> ret;
+	uint16_t size_a;
+
+	size_a = a.size_;
+	if (!size_a) return ret;
+
+	limbs_sqr(square, a.parts_, size_a);
+	reduce_any(square, 2u * size_a, ret.parts_);
+	ret.trim(size_);
+	return ret;
+}
+
+// --- instantiations ---
+
+template class BarrettContext<256u>;
+template class BarrettContext<512u>;
+template class BarrettContext<1024u>;
+template class BarrettContext<1536u>;
+template class BarrettContext<2048u>;
+template class BarrettContext<3072u>;
+template class BarrettContext<4096u>;
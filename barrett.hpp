@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "uint2048.hpp"
+
+/*
+
+BarrettContext
+
+precomputes mu = floor(2^(128k) / m) for one fixed modulus m of k limbs
+(barrett, HAC 14.42). a number below 2^(128k) is then reduced with two
+half multiplies, the top half of the product with mu and the bottom half
+of the one with m, and at most three subtractions of m. no division.
+unlike montgomery the numbers stay as they are and m may be even, so this
+is the one to use for even moduli and for reducing plain products.
+
+building one costs a division, use it when the same modulus is reduced
+by more than once.
+instantiated in barrett.cpp for the same widths as uint_t.
+
+*/
+template <uint16_t Bits>
+class BarrettContext{
+private:
+	uint_t<Bits> modulus_;
+	uint64_t mu_[uint_t<Bits>::Limbs + 2u]; // floor(2^(128k) / m), k + 2 limbs when m is a power of 2^64
+	uint16_t mu_size_;   // number of limbs in mu
+	uint16_t size_;      // k, the number of limbs in m
+
+	/*
+	r[0..k) = x[0..n) mod m for n <= 2k
+	*/
+	void reduce_limbs(const uint64_t* x, uint16_t n, uint64_t* r) const;
+
+	/*
+	r[0..k) = x[0..n) mod m for any n, folding in k limbs at a time
+	from the top when x has more than 2k limbs
+	*/
+	void reduce_any(const uint64_t* x, uint16_t n, uint64_t* r) const;
+
+public:
+
+	// --- constructors ---
+
+	/*
+	precomputes mu, the only division.
+	throws std::invalid_argument if the modulus is zero
+	*/
+	BarrettContext(const uint_t<Bits>& modulus);
+
+	// --- functions ---
+
+	const uint_t<Bits>& modulus() const{ return modulus_; }
+
+	/*
+	returns x mod m
+	*/
+	uint_t<Bits> reduce(const uint_t<Bits>& x) const;
+
+	/*
+	returns a * b mod m from the full double width product.
+	a and b do not have to be reduced, the product is cheapest to reduce
+	when they are
+	*/
+	uint_t<Bits> mul_mod(const uint_t<Bits>& a, const uint_t<Bits>& b) const;
+
+	/*
+	returns a * a mod m, mul_mod(a, a) with the cheaper square
+	*/
+	uint_t<Bits> sqr_mod(const uint_t<Bits>& a) const;
+
+};
@@ -0,0 +1,182 @@
+/*
+
+bignum_bench
+
+times the uint2048 operators and the number theory functions on operands
+of 64 to 2048 bits. everything is drawn from a fixed seed, so two runs on
+the same machine time the same numbers and can be compared.
+
+every measurement cycles through a pool of different operands so the
+branch predictor can not learn one of them, and is the best of several
+runs of at least a few milliseconds each.
+
+	+ - * sqr < == gcd_*	both operands have 'bits' bits
+	/ %			a full 2048 bit dividend over a 'bits' bit divisor
+	<< >>			a 'bits' bit operand, shifted by 13
+	to_string from_string	a 'bits' bit operand in decimal
+	Random*, fill_random	one 'bits' bit number, with mt19937_64 or xoshiro256**
+	pow_mod		'bits' bit base, exponent and odd modulus
+	pow_mod_even		the same with the modulus made even
+	miller_rabin_test	a 'bits' bit prime (the case that runs every round), 10 rounds
+	bpsw_test		the same prime
+
+prints csv: op,bits,ns,iterations
+with --json one object with the kernels the build picked and a "results"
+array of objects with the same fields.
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../limb_ops.hpp"
+#include "../primality_tests.hpp"
+#include "../prime_search.hpp"
+#include "../random.hpp"
+#include "../uint2048.hpp"
+
+// number of different operands every measurement cycles through
+#define BENCH_POOL 64u
+
+// keeps the compiler from throwing away the results
+static volatile uint64_t sink;
+
+struct Result{
+	std::string op;
+	uint16_t bits;
+	double ns;
+	unsigned iterations;
+};
+
+/*
+calls f(i) for i = 0, 1, 2 ... and returns the best time per call in ns.
+the iteration count is doubled until one run takes at least 'min_ms'
+*/
+static double time_ns(const std::function<void(unsigned)>& f, double min_ms, unsigned* iterations){
+	auto best = 1e30;
+	auto count = 1u;
+
+	for (;;){
+		auto start = std::chrono::steady_clock::now();
+		for (auto i = 0u; i < count; ++i) f(i);
+		auto stop = std::chrono::steady_clock::now();
+		if (std::chrono::duration<double, std::milli>(stop - start).count() >= min_ms || count >= (1u << 24u)) break;
+		count *= 2u;
+	}
+
+	// best of several runs to filter out noise
+	for (auto run = 0u; run < 5u; ++run){
+		auto start = std::chrono::steady_clock::now();
+		for (auto i = 0u; i < count; ++i) f(i);
+		auto stop = std::chrono::steady_clock::now();
+		auto ns = std::chrono::duration<double, std::nano>(stop - start).count() / count;
+		if (ns < best) best = ns;
+	}
+
+	*iterations = count;
+	return best;
+}
+
+int main(int argc, char** argv){
+	std::mt19937_64 mt_rand{ 1u };
+	Xoshiro256 xoshiro{ 1u };
+	std::vector<Result> results;
+	auto json = false;
+
+	for (auto i = 1; i < argc; ++i){
+		if (!std::strcmp(argv[i], "--json")) json = true;
+		else{
+			fprintf(stderr, "usage: %s [--json]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	auto run = [&](const char* op, uint16_t bits, double min_ms, const std::function<void(unsigned)>& f){
+		Result result{ op, bits, 0.0, 0u };
+
+		result.ns = time_ns(f, min_ms, &result.iterations);
+		results.push_back(result);
+		if (!json){
+			printf("%s,%u,%.1f,%u\n", op, bits, result.ns, result.iterations);
+			fflush(stdout);
+		}
+	};
+
+	if (!json) printf("op,bits,ns,iterations\n");
+
+	for (uint16_t bits = 64u; bits <= 2048u; bits *= 2u){
+		std::vector<uint2048> a(BENCH_POOL), b(BENCH_POOL), c(BENCH_POOL);
+		std::vector<uint2048> dividend(BENCH_POOL), odd(BENCH_POOL), even(BENCH_POOL), filled(BENCH_POOL);
+		std::vector<uint2048> square(BENCH_POOL);
+		std::vector<std::string> decimal(BENCH_POOL);
+		uint2048 prime;
+
+		for (auto i = 0u; i < BENCH_POOL; ++i){
+			a[i] = uint2048::Random(bits, &mt_rand);
+			b[i] = uint2048::Random(bits, &mt_rand);
+			c[i] = a[i] ^ uint2048{ 1ull };
+			dividend[i] = uint2048::Random(2048u, &mt_rand);
+			odd[i] = uint2048::Random(bits, &mt_rand);
+			odd[i] |= uint2048{ 1ull };
+			even[i] = odd[i] ^ uint2048{ 1ull };
+			if (even[i] == 0ull) even[i] = 2ull;
+			decimal[i] = a[i].to_string();
+		}
+		prime = find_prime_seeded<2048u>((bits < 16u) ? 16u : bits, 0u, 1u, mt_rand());
+
+		auto at = [](unsigned i){ return i % BENCH_POOL; };
+
+		run("+", bits, 5.0, [&](unsigned i){ sink = (a[at(i)] + b[at(i)]) & 1ull; });
+		run("-", bits, 5.0, [&](unsigned i){ sink = (a[at(i)] - b[at(i)]) & 1ull; });
+		run("*", bits, 5.0, [&](unsigned i){ sink = (a[at(i)] * b[at(i)]) & 1ull; });
+		run("sqr", bits, 5.0, [&](unsigned i){
+			sqr(a[at(i)], &square[at(i)]);
+			sink = square[at(i)] & 1ull;
+		});
+		run("/", bits, 5.0, [&](unsigned i){ sink = (dividend[at(i)] / b[at(i)]) & 1ull; });
+		run("%", bits, 5.0, [&](unsigned i){ sink = (dividend[at(i)] % b[at(i)]) & 1ull; });
+		run("<<", bits, 5.0, [&](unsigned i){ sink = (a[at(i)] << 13u) & 1ull; });
+		run(">>", bits, 5.0, [&](unsigned i){ sink = (a[at(i)] >> 13u) & 1ull; });
+
+		// a and c only differ in the lowest bit, so every limb is compared
+		run("<", bits, 5.0, [&](unsigned i){ sink = a[at(i)] < c[at(i)]; });
+		run("==", bits, 5.0, [&](unsigned i){ sink = a[at(i)] == c[at(i)]; });
+
+		run("gcd_mod", bits, 20.0, [&](unsigned i){ sink = gcd_mod(a[at(i)], b[at(i)]) & 1ull; });
+		run("gcd_sub", bits, 20.0, [&](unsigned i){ sink = gcd_sub(a[at(i)], b[at(i)]) & 1ull; });
+		run("gcd_binary", bits, 20.0, [&](unsigned i){ sink = gcd_binary(a[at(i)], b[at(i)]) & 1ull; });
+		run("gcd_lehmer", bits, 20.0, [&](unsigned i){ sink = gcd_lehmer(a[at(i)], b[at(i)]) & 1ull; });
+
+		run("to_string", bits, 5.0, [&](unsigned i){ sink = a[at(i)].to_string().size(); });
+		run("from_string", bits, 5.0, [&](unsigned i){ sink = uint2048::from_string(decimal[at(i)]) & 1ull; });
+
+		run("Random", bits, 5.0, [&](unsigned){ sink = uint2048::Random(bits, &mt_rand) & 1ull; });
+		run("Random_xoshiro", bits, 5.0, [&](unsigned){ sink = uint2048::Random(bits, &xoshiro) & 1ull; });
+		run("fill_random", bits, 5.0, [&](unsigned i){
+			fill_random(&filled[at(i)], 1u, bits, &xoshiro);
+			sink = filled[at(i)] & 1ull;
+		});
+		run("pow_mod", bits, 20.0, [&](unsigned i){ sink = pow_mod(a[at(i)], b[at(i)], odd[at(i)]) & 1ull; });
+		run("pow_mod_even", bits, 20.0, [&](unsigned i){ sink = pow_mod(a[at(i)], b[at(i)], even[at(i)]) & 1ull; });
+		run("miller_rabin_test", bits, 20.0, [&](unsigned){ sink = miller_rabin_test(prime, 10u, &mt_rand); });
+		run("bpsw_test", bits, 20.0, [&](unsigned){ sink = bpsw_test(prime); });
+	}
+
+	if (json){
+		printf("{\n\t\"simd\": \"%s\",\n\t\"addmul_1\": \"%s\",\n", LIMBS_SIMD_NAME, limbs_addmul_1_name());
+		printf("\t\"results\": [\n");
+		for (auto i = 0u; i < results.size(); ++i){
+			printf("\t\t{ \"op\": \"%s\", \"bits\": %u, \"ns\": %.1f, \"iterations\": %u }%s\n",
+				results[i].op.c_str(), results[i].bits, results[i].ns, results[i].iterations,
+				(i + 1u < results.size()) ? "," : "");
+		}
+		printf("\t]\n}\n");
+	}
+	return 0;
+}
@@ -0,0 +1,118 @@
+/*
+
+karatsuba_crossover
+
+times the schoolbook basecase against one level of karatsuba (halves done
+with the basecase) for equal sized operands of 2 to 64 limbs, and the
+same for squaring.
+the first size where karatsuba wins is a good value for KARATSUBA_THRESHOLD,
+and for KARATSUBA_SQR_THRESHOLD in the sqr columns.
+
+prints csv: limbs,basecase_ns,karatsuba_ns,speedup,sqr_basecase_ns,sqr_karatsuba_ns,sqr_speedup
+
+before timing, limbs_mul is checked against the basecase for operands of
+unequal length around and above LIMBS_STACK_MAX, where the shorter one gets
+padded and the buffer moves from the stack to the heap. exits with 1 if
+a product is wrong.
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../limb_ops.hpp"
+
+// keeps the compiler from throwing away the products
+static volatile uint64_t sink;
+
+template <typename F>
+static double time_ns(F f, unsigned iterations){
+	auto best = 1e30;
+
+	// best of several runs to filter out noise
+	for (auto run = 0u; run < 7u; ++run){
+		auto start = std::chrono::steady_clock::now();
+		for (auto i = 0u; i < iterations; ++i) f();
+		auto stop = std::chrono::steady_clock::now();
+		auto ns = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+		if (ns < best) best = ns;
+	}
+	return best;
+}
+
+// limbs_mul against the basecase for unequal operands, true if all match
+static bool check_unequal(std::mt19937_64& mt_rand){
+	const uint16_t sizes[][2] = {
+		{ LIMBS_STACK_MAX - 8u, KARATSUBA_THRESHOLD },
+		{ LIMBS_STACK_MAX, KARATSUBA_THRESHOLD },
+		{ LIMBS_STACK_MAX, LIMBS_STACK_MAX - 1u },
+		{ LIMBS_STACK_MAX + 1u, KARATSUBA_THRESHOLD + 1u },
+		{ LIMBS_STACK_MAX + 1u, LIMBS_STACK_MAX },
+		{ 2u * LIMBS_STACK_MAX, KARATSUBA_THRESHOLD },
+		{ 2u * LIMBS_STACK_MAX + 44u, 2u * LIMBS_STACK_MAX + 43u },
+	};
+	auto ok = true;
+
+	for (auto& size : sizes){
+		uint16_t na = size[0], nb = size[1];
+		std::vector<uint64_t> operand_a(na), operand_b(nb), product(na + nb), expected(na + nb);
+
+		for (auto& limb : operand_a) limb = mt_rand();
+		for (auto& limb : operand_b) limb = mt_rand();
+
+		limbs_mul(product.data(), operand_a.data(), na, operand_b.data(), nb);
+		limbs_mul_basecase(expected.data(), operand_a.data(), na, operand_b.data(), nb);
+		if (product != expected){
+			fprintf(stderr, "limbs_mul wrong for %u x %u limbs\n", na, nb);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+int main(){
+	std::mt19937_64 mt_rand{ 1u };
+	uint64_t a[64u], b[64u];
+	uint64_t r[128u];
+	uint64_t scratch[KARATSUBA_SCRATCH(64u)];
+
+	if (!check_unequal(mt_rand)) return 1;
+
+	for (auto i = 0u; i < 64u; ++i){
+		a[i] = mt_rand();
+		b[i] = mt_rand();
+	}
+
+	printf("limbs,basecase_ns,karatsuba_ns,speedup,sqr_basecase_ns,sqr_karatsuba_ns,sqr_speedup\n");
+	for (uint16_t n = 2u; n <= 64u; ++n){
+		auto iterations = 200000u / (n * n) + 100u;
+
+		auto basecase = time_ns([&]{
+			limbs_mul_basecase(r, a, n, b, n);
+			sink = r[n];
+		}, iterations);
+
+		// threshold n makes only the top level split
+		auto karatsuba = time_ns([&]{
+			limbs_mul_karatsuba(r, a, b, n, scratch, n);
+			sink = r[n];
+		}, iterations);
+
+		auto sqr_basecase = time_ns([&]{
+			limbs_sqr_basecase(r, a, n);
+			sink = r[n];
+		}, iterations);
+
+		auto sqr_karatsuba = time_ns([&]{
+			limbs_sqr_karatsuba(r, a, n, scratch, n);
+			sink = r[n];
+		}, iterations);
+
+		printf("%u,%.1f,%.1f,%.3f,%.1f,%.1f,%.3f\n", n, basecase, karatsuba, basecase / karatsuba,
+			sqr_basecase, sqr_karatsuba, sqr_basecase / sqr_karatsuba);
+	}
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include "instrument.hpp"
+
+#include <atomic>
+
+#define INSTRUMENT_OPS static_cast<uint8_t>(InstrumentOp::count)
+
+/*
+the live counters, one InstrumentOpStats / InstrumentMrStats made of atomics.
+relaxed is enough, nothing else is ordered against them
+*/
+struct InstrumentOpCounters{
+	std::atomic<uint64_t> calls;
+	std::atomic<uint64_t> limbs;
+	std::atomic<uint64_t> cycles;
+	std::atomic<uint64_t> histogram[INSTRUMENT_BUCKETS];
+};
+
+struct InstrumentMrCounters{
+	std::atomic<uint64_t> tests;
+	std::atomic<uint64_t> trivial;
+	std::atomic<uint64_t> trial_division;
+	std::atomic<uint64_t> rounds[INSTRUMENT_ROUNDS];
+	std::atomic<uint64_t> passed;
+};
+
+// zero initialized before anything runs, no static initialization order to worry about
+static InstrumentOpCounters op_counters[INSTRUMENT_OPS];
+static InstrumentMrCounters mr_counters;
+
+static const char* const op_names[INSTRUMENT_OPS] =
+{
+	"add", "sub", "mul", "sqr", "mul_1", "divmod", "div_1", "shift",
+	"compare", "mod_arith", "pow_mod", "mont_mul", "mont_sqr", "barrett", "gcd"
+};
+
+static uint64_t load(const std::atomic<uint64_t>& counter){
+	return counter.load(std::memory_order_relaxed);
+}
+static void clear(std::atomic<uint64_t>* counter){
+	counter->store(0ull, std::memory_order_relaxed);
+}
+static void increment(std::atomic<uint64_t>* counter, uint64_t value){
+	counter->fetch_add(value, std::memory_order_relaxed);
+}
+
+// --- functions ---
+
+bool instrument_enabled(){
+#if defined(BIGNUM_INSTRUMENT)
+	return true;
+#else
+	return false;
+#endif
+}
+
+InstrumentSnapshot instrument_snapshot(){
+	InstrumentSnapshot ret;
+
+	for (auto op = 0u; op < INSTRUMENT_OPS; ++op){
+		ret.ops[op].calls = load(op_counters[op].calls);
+		ret.ops[op].limbs = load(op_counters[op].limbs);
+		ret.ops[op].cycles = load(op_counters[op].cycles);
+		for (auto i = 0u; i < INSTRUMENT_BUCKETS; ++i) ret.ops[op].histogram[i] = load(op_counters[op].histogram[i]);
+	}
+
+	ret.miller_rabin.tests = load(mr_counters.tests);
+	ret.miller_rabin.trivial = load(mr_counters.trivial);
+	ret.miller_rabin.trial_division = load(mr_counters.trial_division);
+	for (auto i = 0u; i < INSTRUMENT_ROUNDS; ++i) ret.miller_rabin.rounds[i] = load(mr_counters.rounds[i]);
+	ret.miller_rabin.passed = load(mr_counters.passed);
+	return ret;
+}
+
+void instrument_reset(){
+	for (auto op = 0u; op < INSTRUMENT_OPS; ++op){
+		clear(&op_counters[op].calls);
+		clear(&op_counters[op].limbs);
+		clear(&op_counters[op].cycles);
+		for (auto i = 0u; i < INSTRUMENT_BUCKETS; ++i) clear(&op_counters[op].histogram[i]);
+	}
+
+	clear(&mr_counters.tests);
+	clear(&mr_counters.trivial);
+	clear(&mr_counters.trial_division);
+	for (auto i = 0u; i < INSTRUMENT_ROUNDS; ++i) clear(&mr_counters.rounds[i]);
+	clear(&mr_counters.passed);
+}
+
+const char* instrument_op_name(InstrumentOp op){
+	auto index = static_cast<uint8_t>(op);
+
+	return (index < INSTRUMENT_OPS) ? op_names[index] : "unknown";
+}
+
+void instrument_record(InstrumentOp op, uint64_t limbs, uint64_t cycles){
+	unsigned long bucket;
+	auto& counters = op_counters[static_cast<uint8_t>(op)];
+
+	// bsr instruction
+	if (!_BitScanReverse64(&bucket, cycles)) bucket = 0ul;
+
+	increment(&counters.calls, 1ull);
+	increment(&counters.limbs, limbs);
+	increment(&counters.cycles, cycles);
+	increment(&counters.histogram[bucket], 1ull);
+}
+
+void instrument_mr_record(InstrumentMrEvent event, unsigned round){
+	switch (event){
+	case InstrumentMrEvent::test:
+		increment(&mr_counters.tests, 1ull);
+		break;
+	case InstrumentMrEvent::trivial:
+		increment(&mr_counters.trivial, 1ull);
+		break;
+	case InstrumentMrEvent::trial_division:
+		increment(&mr_counters.trial_division, 1ull);
+		break;
+	case InstrumentMrEvent::round:
+		increment(&mr_counters.rounds[(round < INSTRUMENT_ROUNDS) ? round : INSTRUMENT_ROUNDS - 1u], 1ull);
+		break;
+	case InstrumentMrEvent::passed:
+		increment(&mr_counters.passed, 1ull);
+		break;
+	}
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+
+#include "intrinsics.hpp"
+
+/*
+
+instrumentation
+
+call and limb counters and rdtsc latency histograms for the operators in
+uint2048.cpp, the montgomery and barrett reductions, and a breakdown of
+where miller_rabin_test and bpsw_test reject their candidates.
+
+off by default. the probes only exist when the library is built with
+-DBIGNUM_INSTRUMENT (cmake -DBIGNUM_INSTRUMENT=ON), otherwise they are
+((void)0) and the operators compile to what they were without them.
+the snapshot / reset functions are always there and return zeros when
+the probes are compiled out, so callers do not need the define.
+
+the counters are relaxed atomics, safe to update from the find_prime
+workers and to read while they run. a snapshot taken while other threads
+are counting is not one consistent point in time.
+every probe costs two rdtsc reads and a few atomic adds, a few dozen
+cycles that are part of what it measures, so the cycles of the short
+operators (add, compare, shift) are mostly the probe itself.
+
+*/
+
+/*
+the operations that are counted.
+an operation that calls another one counts in both, pow_mod includes the
+mont_mul and mont_sqr calls it makes and gcd_mod the divmod calls
+*/
+enum class InstrumentOp : uint8_t{
+	add,       // + +=, both operands uint_t
+	sub,       // - -=, both operands uint_t
+	mul,       // mul, *, *=, mul_add
+	sqr,
+	mul_1,     // * and *= with a 64 bit operand
+	divmod,    // divmod, / % /= %=
+	div_1,     // / and mod_u64 with a U64Divisor
+	shift,     // <<= >>=
+	compare,   // == < with both operands uint_t
+	mod_arith, // mul_mod, add_mod, sub_mod, sqr_mod
+	pow_mod,
+	mont_mul,  // MontgomeryContext::mont_mul
+	mont_sqr,  // MontgomeryContext::mont_sqr
+	barrett,   // BarrettContext::reduce, mul_mod and sqr_mod
+	gcd,       // gcd_*, ext_gcd
+	count
+};
+
+/*
+histograms have one bucket per power of two, bucket i counts the calls
+that took [2^i, 2^(i + 1)) cycles (bucket 0 also the ones that took 0)
+*/
+#define INSTRUMENT_BUCKETS 64u
+
+/*
+witness rounds miller_rabin_test keeps apart, rejections in later rounds
+are counted in the last one
+*/
+#define INSTRUMENT_ROUNDS 64u
+
+struct InstrumentOpStats{
+	uint64_t calls;                          // number of calls
+	uint64_t limbs;                          // sum of the limbs of the operands
+	uint64_t cycles;                         // sum of the rdtsc cycles
+	uint64_t histogram[INSTRUMENT_BUCKETS];  // calls per log2 of the cycles
+};
+
+/*
+every test ends in exactly one of trivial, trial_division, rounds[k] or
+passed, so they add up to tests
+*/
+struct InstrumentMrStats{
+	uint64_t tests;                      // calls to miller_rabin_test and bpsw_test
+	uint64_t trivial;                    // rejected for being even or <= 3
+	uint64_t trial_division;             // rejected by a small prime factor
+	uint64_t rounds[INSTRUMENT_ROUNDS];  // rejected by the witness of round k
+	uint64_t passed;                     // probably prime
+};
+
+struct InstrumentSnapshot{
+	InstrumentOpStats ops[static_cast<uint8_t>(InstrumentOp::count)];
+	InstrumentMrStats miller_rabin;
+
+	const InstrumentOpStats& operator[](InstrumentOp op) const{ return ops[static_cast<uint8_t>(op)]; }
+};
+
+/*
+what a miller_rabin_test or bpsw_test call ended with, the fields of
+InstrumentMrStats
+*/
+enum class InstrumentMrEvent : uint8_t{
+	test,
+	trivial,
+	trial_division,
+	round,
+	passed
+};
+
+// --- functions ---
+
+/*
+true if the library was built with BIGNUM_INSTRUMENT
+*/
+bool instrument_enabled();
+
+/*
+copies all counters out
+*/
+InstrumentSnapshot instrument_snapshot();
+
+/*
+sets all counters to zero
+*/
+void instrument_reset();
+
+/*
+"add", "sub" ... for op
+*/
+const char* instrument_op_name(InstrumentOp op);
+
+/*
+adds one call of op on 'limbs' limbs that took 'cycles' cycles
+*/
+void instrument_record(InstrumentOp op, uint64_t limbs, uint64_t cycles);
+
+/*
+counts one miller_rabin_test event, 'round' is only used by
+InstrumentMrEvent::round
+*/
+void instrument_mr_record(InstrumentMrEvent event, unsigned round);
+
+// --- probes ---
+
+#if defined(BIGNUM_INSTRUMENT)
+
+/*
+reads the time stamp counter when it is made and records the difference
+when it goes out of scope, so every return of the function is covered
+*/
+class InstrumentScope{
+private:
+	uint64_t start_;
+	uint64_t limbs_;
+	InstrumentOp op_;
+
+public:
+	InstrumentScope(InstrumentOp op, uint64_t limbs) : start_(__rdtsc()), limbs_(limbs), op_(op){}
+	~InstrumentScope(){ instrument_record(op_, limbs_, __rdtsc() - start_); }
+
+	InstrumentScope(const InstrumentScope&) = delete;
+	InstrumentScope& operator=(const InstrumentScope&) = delete;
+};
+
+#define BIGNUM_INSTRUMENT_CONCAT_(a, b) a##b
+#define BIGNUM_INSTRUMENT_CONCAT(a, b) BIGNUM_INSTRUMENT_CONCAT_(a, b)
+
+/*
+times the rest of the enclosing block as one call of InstrumentOp::op
+*/
+#define BIGNUM_INSTRUMENT_SCOPE(op, limbs) \
+	InstrumentScope BIGNUM_INSTRUMENT_CONCAT(instrument_scope_, __LINE__){ InstrumentOp::op, static_cast<uint64_t>(limbs) }
+
+#define BIGNUM_INSTRUMENT_MR(event, round) \
+	instrument_mr_record(InstrumentMrEvent::event, static_cast<unsigned>(round))
+
+#else
+
+#define BIGNUM_INSTRUMENT_SCOPE(op, limbs) ((void)0)
+#define BIGNUM_INSTRUMENT_MR(event, round) ((void)0)
+
+#endif
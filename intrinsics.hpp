@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+
+the MSVC intrinsics the kernels are written against (_umul128, _udiv128,
+_addcarry_u64, _subborrow_u64, _BitScanReverse64, _BitScanForward64,
+_byteswap_uint64), mapped onto GCC / Clang builtins everywhere else.
+x86-64 only.
+
+include this instead of <intrin.h>.
+
+*/
+
+#if defined(_MSC_VER)
+
+#include <intrin.h>
+#include <stdlib.h>
+
+#else
+
+#include <cpuid.h>
+#include <x86intrin.h>
+
+/*
+_BitScanReverse64 / _BitScanForward64
+
+*index = position of the highest / lowest set bit of mask.
+returns 0 and leaves index alone if mask is 0
+*/
+inline unsigned char _BitScanReverse64(unsigned long* index, uint64_t mask){
+	if (!mask) return 0u;
+	*index = 63ul - static_cast<unsigned long>(__builtin_clzll(mask));
+	return 1u;
+}
+inline unsigned char _BitScanForward64(unsigned long* index, uint64_t mask){
+	if (!mask) return 0u;
+	*index = static_cast<unsigned long>(__builtin_ctzll(mask));
+	return 1u;
+}
+
+/*
+_umul128
+
+returns the low limb of a * b, *high gets the high limb
+*/
+inline uint64_t _umul128(uint64_t a, uint64_t b, uint64_t* high){
+	unsigned __int128 product;
+
+	product = static_cast<unsigned __int128>(a) * b;
+	*high = static_cast<uint64_t>(product >> 64u);
+	return static_cast<uint64_t>(product);
+}
+
+/*
+_udiv128
+
+returns high:low / divisor, *remainder gets high:low % divisor.
+high must be less than divisor.
+one div instruction, dividing an __int128 would call into libgcc
+*/
+inline uint64_t _udiv128(uint64_t high, uint64_t low, uint64_t divisor, uint64_t* remainder){
+	uint64_t quotient;
+
+	__asm__("divq %[divisor]"
+		: "=a"(quotient), "=d"(*remainder)
+		: [divisor] "rm"(divisor), "a"(low), "d"(high)
+		: "cc");
+	return quotient;
+}
+
+/*
+_byteswap_uint64
+
+returns value with its bytes in reverse order.
+a bswap instruction, or movbe when it is folded into a load or store
+and the target has it
+*/
+inline uint64_t _byteswap_uint64(uint64_t value){
+	return __builtin_bswap64(value);
+}
+
+#if __SIZEOF_LONG__ == 8
+/*
+<x86intrin.h> declares the carry intrinsics for unsigned long long, but
+uint64_t is unsigned long on 64 bit linux. these forward the uint64_t
+outputs to them
+*/
+inline unsigned char _addcarry_u64(unsigned char carry, unsigned long long a, unsigned long long b, unsigned long* out){
+	return _addcarry_u64(carry, a, b, reinterpret_cast<unsigned long long*>(out));
+}
+inline unsigned char _subborrow_u64(unsigned char borrow, unsigned long long a, unsigned long long b, unsigned long* out){
+	return _subborrow_u64(borrow, a, b, reinterpret_cast<unsigned long long*>(out));
+}
+#endif
+
+#endif
+
+/*
+cpu_has_adx_bmi2
+
+returns true if the cpu this runs on has mulx (BMI2) and adcx / adox (ADX).
+asks cpuid every call, callers keep the answer
+*/
+inline bool cpu_has_adx_bmi2(){
+	unsigned int ebx;
+
+#if defined(_MSC_VER)
+	int info[4];
+
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuidex(info, 7, 0);
+	ebx = static_cast<unsigned int>(info[1]);
+#else
+	unsigned int eax, ecx, edx;
+
+	if (!__get_cpuid_count(7u, 0u, &eax, &ebx, &ecx, &edx)) return false;
+#endif
+
+	// leaf 7 ebx: bit 8 is BMI2, bit 19 is ADX
+	return ((ebx >> 8u) & 1u) && ((ebx >> 19u) & 1u);
+}
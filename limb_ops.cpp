@@ -0,0 +1,843 @@
+#include "limb_ops.hpp"
+
+#include <vector>
+
+// --- copy / bitwise ---
+
+void limbs_copy(uint64_t* r, const uint64_t* a, uint16_t n){
+	auto i = 0u;
+
+#if defined(__AVX512F__)
+	for (; i + 8u <= n; i += 8u)
+		_mm512_storeu_si512(r + i, _mm512_loadu_si512(a + i));
+#elif defined(__AVX2__)
+	for (; i + 4u <= n; i += 4u)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+#endif
+	for (; i < n; ++i) r[i] = a[i];
+}
+
+void limbs_zero(uint64_t* r, uint16_t n){
+	auto i = 0u;
+
+#if defined(__AVX512F__)
+	for (; i + 8u <= n; i += 8u) _mm512_storeu_si512(r + i, _mm512_setzero_si512());
+#elif defined(__AVX2__)
+	for (; i + 4u <= n; i += 4u) _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_setzero_si256());
+#endif
+	for (; i < n; ++i) r[i] = 0ull;
+}
+
+void limbs_and(uint64_t* r, const uint64_t* a, const uint64_t* b, uint16_t n){
+	auto i = 0u;
+
+#if defined(__AVX512F__)
+	for (; i + 8u <= n; i += 8u)
+		_mm512_storeu_si512(r + i, _mm512_and_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+#elif defined(__AVX2__)
+	for (; i + 4u <= n; i += 4u){
+		auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_and_si256(x, y));
+	}
+#endif
+	for (; i < n; ++i) r[i] = a[i] & b[i];
+}
+
+void limbs_or(uint64_t* r, const uint64_t* a, const uint64_t* b, uint16_t n){
+	auto i = 0u;
+
+#if defined(__AVX512F__)
+	for (; i + 8u <= n; i += 8u)
+		_mm512_storeu_si512(r + i, _mm512_or_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+#elif defined(__AVX2__)
+	for (; i + 4u <= n; i += 4u){
+		auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_or_si256(x, y));
+	}
+#endif
+	for (; i < n; ++i) r[i] = a[i] | b[i];
+}
+
+void limbs_xor(uint64_t* r, const uint64_t* a, const uint64_t* b, uint16_t n){
+	auto i = 0u;
+
+#if defined(__AVX512F__)
+	for (; i + 8u <= n; i += 8u)
+		_mm512_storeu_si512(r + i, _mm512_xor_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+#elif defined(__AVX2__)
+	for (; i + 4u <= n; i += 4u){
+		auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_xor_si256(x, y));
+	}
+#endif
+	for (; i < n; ++i) r[i] = a[i] ^ b[i];
+}
+
+void limbs_not(uint64_t* r, const uint64_t* a, uint16_t n){
+	auto i = 0u;
+
+#if defined(__AVX512F__)
+	// ternary logic 0x55 is ~c
+	for (; i + 8u <= n; i += 8u){
+		auto x = _mm512_loadu_si512(a + i);
+		_mm512_storeu_si512(r + i, _mm512_ternarylogic_epi64(x, x, x, 0x55));
+	}
+#elif defined(__AVX2__)
+	auto ones = _mm256_set1_epi64x(-1ll);
+	for (; i + 4u <= n; i += 4u){
+		auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_xor_si256(x, ones));
+	}
+#endif
+	for (; i < n; ++i) r[i] = ~a[i];
+}
+
+// --- comparison ---
+
+int limbs_cmp(const uint64_t* a, const uint64_t* b, uint16_t n){
+	auto i = static_cast<uint32_t>(n);
+
+	// whole vectors from the top down, the limbs below the last one after
+#if defined(__AVX512F__)
+	while (i >= 8u){
+		i -= 8u;
+		auto mask = _mm512_cmpneq_epu64_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+		if (mask){
+			unsigned long index;
+
+			// intrinsic function
+			// bsr instruction
+			// index of the most significant limb that differs
+			_BitScanReverse64(&index, mask);
+			i += index;
+			return (a[i] < b[i]) ? -1 : 1;
+		}
+	}
+#elif defined(__AVX2__)
+	while (i >= 4u){
+		i -= 4u;
+		auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+
+		// one bit per limb, set where the limbs differ
+		auto mask = ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, y))) & 0xf;
+		if (mask){
+			unsigned long index;
+
+			// intrinsic function
+			// bsr instruction
+			// index of the most significant limb that differs
+			_BitScanReverse64(&index, static_cast<uint64_t>(mask));
+			i += index;
+			return (a[i] < b[i]) ? -1 : 1;
+		}
+	}
+#endif
+	while (i > 0u){
+		--i;
+		if (a[i] != b[i]) return (a[i] < b[i]) ? -1 : 1;
+	}
+	return 0;
+}
+
+// --- shifts ---
+
+uint64_t limbs_shl(uint64_t* r, const uint64_t* a, uint16_t n, uint16_t bits){
+	uint64_t ret;
+	auto i = static_cast<uint32_t>(n);
+
+	if (!n) return 0ull;
+	if (!bits){
+		// walk down, r may start above a
+		for (; i > 0u; --i) r[i - 1u] = a[i - 1u];
+		return 0ull;
+	}
+	ret = a[n - 1u] >> (64u - bits);
+
+	// walk down so every limb of a is read before r overwrites it.
+	// limb i is a[i] << bits | a[i - 1] >> (64 - bits), so the vectors
+	// at a + i and a + i - 1 give a whole vector of results
+#if defined(__AVX512F__)
+	// the zero masked forms with every lane set, the unmasked ones pass an
+	// undefined vector through that gcc 12 flags with -Wmaybe-uninitialized
+	auto left = _mm_cvtsi32_si128(bits);
+	auto right = _mm_cvtsi32_si128(64u - bits);
+	while (i >= 9u){
+		i -= 8u;
+		auto hi = _mm512_loadu_si512(a + i);
+		auto lo = _mm512_loadu_si512(a + i - 1u);
+		_mm512_storeu_si512(r + i, _mm512_or_si512(_mm512_maskz_sll_epi64(0xff, hi, left), _mm512_maskz_srl_epi64(0xff, lo, right)));
+	}
+#elif defined(__AVX2__)
+	auto left = _mm_cvtsi32_si128(bits);
+	auto right = _mm_cvtsi32_si128(64u - bits);
+	while (i >= 5u){
+		i -= 4u;
+		auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i - 1u));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_or_si256(_mm256_sll_epi64(hi, left), _mm256_srl_epi64(lo, right)));
+	}
+#endif
+	for (; i > 1u; --i) r[i - 1u] = (a[i - 1u] << bits) | (a[i - 2u] >> (64u - bits));
+	r[0] = a[0] << bits;
+	return ret;
+}
+
+void limbs_shr(uint64_t* r, const uint64_t* a, uint16_t n, uint16_t bits){
+	auto i = 0u;
+
+	if (!n) return;
+	if (!bits){
+		// walk up, r may start below a
+		for (; i < n; ++i) r[i] = a[i];
+		return;
+	}
+
+	// walk up so every limb of a is read before r overwrites it.
+	// limb i is a[i] >> bits | a[i + 1] << (64 - bits)
+#if defined(__AVX512F__)
+	// zero masked for the same reason as in limbs_shl
+	auto right = _mm_cvtsi32_si128(bits);
+	auto left = _mm_cvtsi32_si128(64u - bits);
+	for (; i + 9u <= n; i += 8u){
+		auto lo = _mm512_loadu_si512(a + i);
+		auto hi = _mm512_loadu_si512(a + i + 1u);
+		_mm512_storeu_si512(r + i, _mm512_or_si512(_mm512_maskz_srl_epi64(0xff, lo, right), _mm512_maskz_sll_epi64(0xff, hi, left)));
+	}
+#elif defined(__AVX2__)
+	auto right = _mm_cvtsi32_si128(bits);
+	auto left = _mm_cvtsi32_si128(64u - bits);
+	for (; i + 5u <= n; i += 4u){
+		auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 1u));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_or_si256(_mm256_srl_epi64(lo, right), _mm256_sll_epi64(hi, left)));
+	}
+#endif
+	for (; i + 1u < n; ++i) r[i] = (a[i] >> bits) | (a[i + 1u] << (64u - bits));
+	r[n - 1u] = a[n - 1u] >> bits;
+}
+
+// --- addition / subtraction ---
+
+uint8_t limbs_add(uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb){
+	uint8_t carry_flag = 0u;
+	auto i = 0u;
+
+	for (; i < nb; ++i)
+		carry_flag = _addcarry_u64(carry_flag, a[i], b[i], &r[i]);
+	for (; i < na; ++i)
+		carry_flag = _addcarry_u64(carry_flag, a[i], 0ull, &r[i]);
+	return carry_flag;
+}
+
+uint8_t limbs_sub(uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb){
+	uint8_t borrow_flag = 0u;
+	auto i = 0u;
+
+	for (; i < nb; ++i)
+		borrow_flag = _subborrow_u64(borrow_flag, a[i], b[i], &r[i]);
+	for (; i < na; ++i)
+		borrow_flag = _subborrow_u64(borrow_flag, a[i], 0ull, &r[i]);
+	return borrow_flag;
+}
+
+// --- multiplication ---
+
+uint64_t limbs_mul_1(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b){
+	uint64_t lo, hi;
+	uint64_t carry = 0ull;
+	uint8_t carry_flag;
+
+	for (auto i = 0u; i < n; ++i){
+		// intrinsic function
+		// mul instruction
+		// hi:lo = a[i] * b
+		lo = _umul128(a[i], b, &hi);
+
+		// add the high limb of the previous product into this one
+		carry_flag = _addcarry_u64(0u, lo, carry, &r[i]);
+		carry = hi + carry_flag;
+	}
+	return carry;
+}
+
+uint64_t limbs_addmul_1_generic(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b){
+	uint64_t lo, hi;
+	uint64_t carry = 0ull;
+	uint8_t carry_flag;
+
+	for (auto i = 0u; i < n; ++i){
+		// intrinsic function
+		// mul instruction
+		// hi:lo = a[i] * b
+		lo = _umul128(a[i], b, &hi);
+
+		// lo + carry + r[i] can not overflow hi:lo because
+		// (2^64 - 1)^2 + 2 * (2^64 - 1) = 2^128 - 1
+		carry_flag = _addcarry_u64(0u, lo, carry, &lo);
+		hi += carry_flag;
+		carry_flag = _addcarry_u64(0u, lo, r[i], &r[i]);
+		carry = hi + carry_flag;
+	}
+	return carry;
+}
+
+uint64_t limbs_addmul_1_adx(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b){
+#if defined(__GNUC__) && defined(__x86_64__)
+	uint64_t carry = 0ull;
+	uint64_t count, quads, lo, hi, limb;
+
+	count = n % 4u;
+	quads = n / 4u;
+
+	/*
+	r[i] = r[i] + lo(a[i] * b) + hi(a[i - 1] * b)
+	adcx only touches CF and adox only OF, so the two sums carry separately.
+	mov, lea and jrcxz leave both flags alone, the loop counters can not use dec.
+	the n % 4 odd limbs go one at a time first, then four per pass with the
+	high limb alternating between hi and carry.
+	at the end both chains are flushed into the high limb, which can not
+	overflow since r + a * b fits in n + 1 limbs
+	*/
+	__asm__ volatile(
+		"xorl %k[lo], %k[lo]\n\t"
+		"jrcxz 3f\n\t"
+		"1:\n\t"
+		"mulx (%[a]), %[lo], %[hi]\n\t"
+		"movq (%[r]), %[limb]\n\t"
+		"adcx %[lo], %[limb]\n\t"
+		"adox %[carry], %[limb]\n\t"
+		"movq %[limb], (%[r])\n\t"
+		"movq %[hi], %[carry]\n\t"
+		"leaq 8(%[a]), %[a]\n\t"
+		"leaq 8(%[r]), %[r]\n\t"
+		"leaq -1(%[count]), %[count]\n\t"
+		"jrcxz 3f\n\t"
+		"jmp 1b\n\t"
+		"3:\n\t"
+		"movq %[quads], %[count]\n\t"
+		"jrcxz 2f\n\t"
+		"4:\n\t"
+		"mulx (%[a]), %[lo], %[hi]\n\t"
+		"movq (%[r]), %[limb]\n\t"
+		"adcx %[lo], %[limb]\n\t"
+		"adox %[carry], %[limb]\n\t"
+		"movq %[limb], (%[r])\n\t"
+		"mulx 8(%[a]), %[lo], %[carry]\n\t"
+		"movq 8(%[r]), %[limb]\n\t"
+		"adcx %[lo], %[limb]\n\t"
+		"adox %[hi], %[limb]\n\t"
+		"movq %[limb], 8(%[r])\n\t"
+		"mulx 16(%[a]), %[lo], %[hi]\n\t"
+		"movq 16(%[r]), %[limb]\n\t"
+		"adcx %[lo], %[limb]\n\t"
+		"adox %[carry], %[limb]\n\t"
+		"movq %[limb], 16(%[r])\n\t"
+		"mulx 24(%[a]), %[lo], %[carry]\n\t"
+		"movq 24(%[r]), %[limb]\n\t"
+		"adcx %[lo], %[limb]\n\t"
+		"adox %[hi], %[limb]\n\t"
+		"movq %[limb], 24(%[r])\n\t"
+		"leaq 32(%[a]), %[a]\n\t"
+		"leaq 32(%[r]), %[r]\n\t"
+		"leaq -1(%[count]), %[count]\n\t"
+		"jrcxz 2f\n\t"
+		"jmp 4b\n\t"
+		"2:\n\t"
+		"movl $0, %k[lo]\n\t"
+		"adcx %[lo], %[carry]\n\t"
+		"adox %[lo], %[carry]\n\t"
+		: [carry] "+&r"(carry), [a] "+&r"(a), [r] "+&r"(r), [count] "+&c"(count),
+		  [lo] "=&r"(lo), [hi] "=&r"(hi), [limb] "=&r"(limb)
+		: "d"(b), [quads] "r"(quads)
+		: "cc", "memory");
+	return carry;
+#else
+	return limbs_addmul_1_generic(r, a, n, b);
+#endif
+}
+
+/*
+the version of limbs_addmul_1 for this cpu, picked on first use
+*/
+static bool use_adx(){
+#if defined(__GNUC__) && defined(__x86_64__)
+	static const bool adx = cpu_has_adx_bmi2();
+	return adx;
+#else
+	return false;
+#endif
+}
+
+uint64_t limbs_addmul_1(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b){
+	if (use_adx()) return limbs_addmul_1_adx(r, a, n, b);
+	return limbs_addmul_1_generic(r, a, n, b);
+}
+
+const char* limbs_addmul_1_name(){
+	return use_adx() ? "adx" : "generic";
+}
+
+uint64_t limbs_submul_1(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b){
+	uint64_t lo, hi;
+	uint64_t borrow = 0ull;
+	uint8_t carry_flag;
+
+	for (auto i = 0u; i < n; ++i){
+		// intrinsic function
+		// mul instruction
+		// hi:lo = a[i] * b
+		lo = _umul128(a[i], b, &hi);
+
+		carry_flag = _addcarry_u64(0u, lo, borrow, &lo);
+		hi += carry_flag;
+		carry_flag = _subborrow_u64(0u, r[i], lo, &r[i]);
+		borrow = hi + carry_flag;
+	}
+	return borrow;
+}
+
+void limbs_mul_basecase(uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb){
+	// keep the longer operand in the inner loop
+	if (na < nb){
+		const uint64_t* t = a;
+		uint16_t tn = na;
+
+		a = b;
+		na = nb;
+		b = t;
+		nb = tn;
+	}
+
+	// the first row initializes r, the rest accumulate into it
+	r[na] = limbs_mul_1(r, a, na, b[0]);
+	for (auto j = 1u; j < nb; ++j)
+		r[j + na] = limbs_addmul_1(r + j, a, na, b[j]);
+}
+
+void limbs_mul_karatsuba(uint64_t* r, const uint64_t* a, const uint64_t* b, uint16_t n,
+	uint64_t* scratch, uint16_t threshold){
+	if (n < threshold || n < 2u){
+		limbs_mul_basecase(r, a, n, b, n);
+		return;
+	}
+
+	/*
+	a = a1 * B^h + a0, b = b1 * B^h + b0 with B = 2^64
+	z0 = a0 * b0
+	z2 = a1 * b1
+	z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+	a * b = z2 * B^2h + z1 * B^h + z0
+	*/
+	uint16_t h, m;
+	uint64_t *sum_a, *sum_b, *z1;
+	uint8_t carry_a, carry_b;
+
+	h = n / 2u;
+	m = n - h;
+	sum_a = scratch;
+	sum_b = sum_a + m;
+	z1 = sum_b + m;
+
+	// z0 goes in the low half of r and z2 in the high half
+	limbs_mul_karatsuba(r, a, b, h, scratch, threshold);
+	limbs_mul_karatsuba(r + 2u * h, a + h, b + h, m, scratch, threshold);
+
+	// the sums are m limbs plus a carry bit each
+	carry_a = limbs_add(sum_a, a + h, m, a, h);
+	carry_b = limbs_add(sum_b, b + h, m, b, h);
+
+	limbs_mul_karatsuba(z1, sum_a, sum_b, m, z1 + 2u * m + 1u, threshold);
+	z1[2u * m] = 0ull;
+
+	// fold the carry bits of the sums back into z1
+	if (carry_a) z1[2u * m] += limbs_add(z1 + m, z1 + m, m, sum_b, m);
+	if (carry_b) z1[2u * m] += limbs_add(z1 + m, z1 + m, m, sum_a, m);
+	z1[2u * m] += carry_a & carry_b;
+
+	limbs_sub(z1, z1, 2u * m + 1u, r, 2u * h);
+	limbs_sub(z1, z1, 2u * m + 1u, r + 2u * h, 2u * m);
+
+	// the full product fits in 2n limbs, so the carry stops inside r
+	limbs_add(r + h, r + h, 2u * n - h, z1, 2u * m + 1u);
+}
+
+void limbs_mul(uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb){
+	if (na < KARATSUBA_THRESHOLD || nb < KARATSUBA_THRESHOLD){
+		limbs_mul_basecase(r, a, na, b, nb);
+		return;
+	}
+
+	uint16_t n;
+	uint64_t stack_buffer[4u * LIMBS_STACK_MAX + KARATSUBA_SCRATCH(LIMBS_STACK_MAX)];
+	std::vector<uint64_t> heap_buffer;
+	uint64_t* buffer;
+
+	// karatsuba wants operands of equal length, pad the shorter one with zeros.
+	// the padded operands and their product take 4n limbs ahead of the scratch
+	n = (na > nb) ? na : nb;
+	if (n <= LIMBS_STACK_MAX) buffer = stack_buffer;
+	else{
+		heap_buffer.resize(4u * n + KARATSUBA_SCRATCH(n));
+		buffer = heap_buffer.data();
+	}
+
+	if (na == nb){
+		limbs_mul_karatsuba(r, a, b, n, buffer);
+		return;
+	}
+
+	uint64_t *pad_a, *pad_b, *product, *scratch;
+
+	pad_a = buffer;
+	pad_b = pad_a + n;
+	product = pad_b + n;
+	scratch = product + 2u * n;
+	for (auto i = 0u; i < n; ++i){
+		pad_a[i] = (i < na) ? a[i] : 0ull;
+		pad_b[i] = (i < nb) ? b[i] : 0ull;
+	}
+	limbs_mul_karatsuba(product, pad_a, pad_b, n, scratch);
+	for (auto i = 0u; i < na + nb; ++i) r[i] = product[i];
+}
+
+void limbs_sqr_basecase(uint64_t* r, const uint64_t* a, uint16_t n){
+	uint64_t low, high, top_bit, limb_low, limb_high;
+	uint8_t carry_flag;
+
+	/*
+	the triangle a[i] * a[j], j > i, one row per i starting at limb 2i + 1.
+	every row ends one limb higher than the one before it, so its carry
+	limb is written, not added
+	*/
+	r[0] = 0ull;
+	r[2u * n - 1u] = 0ull;
+	if (n > 1u){
+		r[n] = limbs_mul_1(r + 1u, a + 1u, n - 1u, a[0]);
+		for (auto i = 1u; i + 1u < n; ++i)
+			r[n + i] = limbs_addmul_1(r + 2u * i + 1u, a + i + 1u, n - i - 1u, a[i]);
+	}
+
+	/*
+	r = 2 * r + the diagonal, the doubling is a shift by one bit that is
+	done two limbs at a time on the way. a^2 fits in 2n limbs, so the
+	last carry is zero
+	*/
+	top_bit = 0ull;
+	carry_flag = 0u;
+	for (auto i = 0u; i < n; ++i){
+		limb_low = (r[2u * i] << 1u) | top_bit;
+		limb_high = (r[2u * i + 1u] << 1u) | (r[2u * i] >> 63u);
+		top_bit = r[2u * i + 1u] >> 63u;
+
+		// intrinsic function
+		// mul instruction
+		low = _umul128(a[i], a[i], &high);
+
+		// intrinsic function
+		// adc instruction
+		carry_flag = _addcarry_u64(carry_flag, limb_low, low, &r[2u * i]);
+		carry_flag = _addcarry_u64(carry_flag, limb_high, high, &r[2u * i + 1u]);
+	}
+}
+
+void limbs_sqr_karatsuba(uint64_t* r, const uint64_t* a, uint16_t n,
+	uint64_t* scratch, uint16_t threshold){
+	if (n < threshold || n < 2u){
+		limbs_sqr_basecase(r, a, n);
+		return;
+	}
+
+	/*
+	a = a1 * B^h + a0 with B = 2^64
+	z0 = a0^2
+	z2 = a1^2
+	z1 = (a0 + a1)^2 - z0 - z2
+	a^2 = z2 * B^2h + z1 * B^h + z0
+	*/
+	uint16_t h, m;
+	uint64_t *sum, *z1;
+	uint8_t carry;
+
+	h = n / 2u;
+	m = n - h;
+	sum = scratch;
+	z1 = sum + m;
+
+	// z0 goes in the low half of r and z2 in the high half
+	limbs_sqr_karatsuba(r, a, h, scratch, threshold);
+	limbs_sqr_karatsuba(r + 2u * h, a + h, m, scratch, threshold);
+
+	// the sum is m limbs plus a carry bit
+	carry = limbs_add(sum, a + h, m, a, h);
+
+	limbs_sqr_karatsuba(z1, sum, m, z1 + 2u * m + 1u, threshold);
+	z1[2u * m] = 0ull;
+
+	// (sum + B^m)^2 = sum^2 + 2 * sum * B^m + B^2m
+	if (carry){
+		z1[2u * m] += limbs_add(z1 + m, z1 + m, m, sum, m);
+		z1[2u * m] += limbs_add(z1 + m, z1 + m, m, sum, m);
+		z1[2u * m] += 1ull;
+	}
+
+	limbs_sub(z1, z1, 2u * m + 1u, r, 2u * h);
+	limbs_sub(z1, z1, 2u * m + 1u, r + 2u * h, 2u * m);
+
+	// the full square fits in 2n limbs, so the carry stops inside r
+	limbs_add(r + h, r + h, 2u * n - h, z1, 2u * m + 1u);
+}
+
+void limbs_sqr(uint64_t* r, const uint64_t* a, uint16_t n){
+	if (n < KARATSUBA_SQR_THRESHOLD){
+		limbs_sqr_basecase(r, a, n);
+		return;
+	}
+
+	uint64_t stack_buffer[KARATSUBA_SCRATCH(LIMBS_STACK_MAX)];
+	std::vector<uint64_t> heap_buffer;
+	uint64_t* buffer;
+
+	if (n <= LIMBS_STACK_MAX) buffer = stack_buffer;
+	else{
+		heap_buffer.resize(KARATSUBA_SCRATCH(n));
+		buffer = heap_buffer.data();
+	}
+	limbs_sqr_karatsuba(r, a, n, buffer);
+}
+
+// --- division ---
+
+uint64_t limbs_divmod_1(uint64_t* q, const uint64_t* a, uint16_t n, uint64_t d){
+	uint64_t rem = 0ull;
+
+	// rem < d at every step, so the 128/64 division can not overflow
+	for (auto i = n; i > 0u; --i){
+		// intrinsic function
+		// div instruction
+		// q = rem:a / d, rem = rem:a % d
+		q[i - 1u] = _udiv128(rem, a[i - 1u], d, &rem);
+	}
+	return rem;
+}
+
+uint64_t limbs_reciprocal_1(uint64_t d){
+	uint64_t rem;
+
+	// (2^128 - 1) - 2^64 * d = ~d:~0, and ~d < d since the top bit of d is set
+	return _udiv128(~d, ~0ull, d, &rem);
+}
+
+uint64_t limbs_divmod_1_preinv(uint64_t* q, const uint64_t* a, uint16_t n, uint64_t d, uint8_t shift, uint64_t v){
+	uint64_t rem, part, lo, hi;
+	uint8_t carry_flag;
+
+	if (!n) return 0ull;
+
+	// the dividend is shifted along with the divisor.
+	// the bits shifted out of the top limb are where the remainder starts
+	rem = shift ? a[n - 1u] >> (64u - shift) : 0ull;
+
+	for (auto i = n; i > 0u; --i){
+		part = a[i - 1u] << shift;
+		if (shift && i > 1u) part |= a[i - 2u] >> (64u - shift);
+
+		// intrinsic function
+		// mul instruction
+		// hi:lo = v * rem + (rem + 1):part
+		lo = _umul128(v, rem, &hi);
+		carry_flag = _addcarry_u64(0u, lo, part, &lo);
+		_addcarry_u64(carry_flag, hi, rem + 1ull, &hi);
+
+		// hi is the quotient limb or one off in either direction
+		rem = part - hi * d;
+		if (rem > lo){
+			--hi;
+			rem += d;
+		}
+		if (rem >= d){
+			++hi;
+			rem -= d;
+		}
+		if (q) q[i - 1u] = hi;
+	}
+	return rem >> shift;
+}
+
+void limbs_divmod(uint64_t* q, uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb){
+	if (nb == 1u){
+		uint64_t stack_buffer[2u * LIMBS_STACK_MAX];
+		std::vector<uint64_t> heap_buffer;
+		uint64_t* quotient = q;
+
+		if (!quotient){
+			if (na <= 2u * LIMBS_STACK_MAX) quotient = stack_buffer;
+			else{
+				heap_buffer.resize(na);
+				quotient = heap_buffer.data();
+			}
+		}
+		r[0] = limbs_divmod_1(quotient, a, na, b[0]);
+		return;
+	}
+
+	uint64_t stack_buffer[3u * LIMBS_STACK_MAX + 1u];
+	std::vector<uint64_t> heap_buffer;
+	uint64_t *u, *v;
+	uint64_t qhat, rhat, lo, hi, top, borrow;
+	auto index = 0ul;
+	uint16_t shift;
+	uint8_t carry_flag;
+
+	if (na + nb + 1u <= 3u * LIMBS_STACK_MAX + 1u) u = stack_buffer;
+	else{
+		heap_buffer.resize(na + nb + 1u);
+		u = heap_buffer.data();
+	}
+	v = u + na + 1u;
+
+	// D1. normalize so the top bit of the divisor is set
+	_BitScanReverse64(&index, b[nb - 1u]);
+	shift = 63u - static_cast<uint16_t>(index);
+	if (shift){
+		for (auto i = nb - 1u; i > 0u; --i) v[i] = (b[i] << shift) | (b[i - 1u] >> (64u - shift));
+		v[0] = b[0] << shift;
+		u[na] = a[na - 1u] >> (64u - shift);
+		for (auto i = na - 1u; i > 0u; --i) u[i] = (a[i] << shift) | (a[i - 1u] >> (64u - shift));
+		u[0] = a[0] << shift;
+	}
+	else{
+		for (auto i = 0u; i < nb; ++i) v[i] = b[i];
+		for (auto i = 0u; i < na; ++i) u[i] = a[i];
+		u[na] = 0ull;
+	}
+
+	top = v[nb - 1u];
+	for (auto j = na - nb + 1u; j > 0u; --j){
+		auto* window = u + j - 1u;
+
+		// D3. estimate the quotient limb from the top two limbs of the window
+		if (window[nb] >= top){
+			// the estimate would overflow a limb, clamp it
+			qhat = ~0ull;
+			carry_flag = _addcarry_u64(0u, window[nb - 1u], top, &rhat);
+		}
+		else{
+			// intrinsic function
+			// div instruction
+			qhat = _udiv128(window[nb], window[nb - 1u], top, &rhat);
+			carry_flag = 0u;
+		}
+
+		// refine with the second limb of the divisor.
+		// once rhat overflows a limb the estimate can no longer be too big
+		while (!carry_flag){
+			lo = _umul128(qhat, v[nb - 2u], &hi);
+			if (hi < rhat || (hi == rhat && lo <= window[nb - 2u])) break;
+			--qhat;
+			carry_flag = _addcarry_u64(0u, rhat, top, &rhat);
+		}
+
+		// D4. multiply and subtract
+		borrow = limbs_submul_1(window, v, nb, qhat);
+		carry_flag = _subborrow_u64(0u, window[nb], borrow, &window[nb]);
+
+		// D6. the estimate was one too big, add the divisor back
+		if (carry_flag){
+			--qhat;
+			window[nb] += limbs_add(window, window, nb, v, nb);
+		}
+
+		if (q) q[j - 1u] = qhat;
+	}
+
+	// D8. unnormalize the remainder
+	if (shift){
+		for (auto i = 0u; i < nb - 1u; ++i) r[i] = (u[i] >> shift) | (u[i + 1u] << (64u - shift));
+		r[nb - 1u] = u[nb - 1u] >> shift;
+	}
+	else for (auto i = 0u; i < nb; ++i) r[i] = u[i];
+}
+
+// --- montgomery ---
+
+void limbs_mont_mul(uint64_t* r, const uint64_t* a, const uint64_t* b,
+	const uint64_t* n, uint16_t k, uint64_t n0_inv){
+	uint64_t stack_buffer[2u * LIMBS_STACK_MAX + 2u];
+	std::vector<uint64_t> heap_buffer;
+	uint64_t *t, *u;
+	uint64_t m, carry;
+	uint8_t carry_flag;
+
+	if (k <= LIMBS_STACK_MAX) t = stack_buffer;
+	else{
+		heap_buffer.resize(2u * k + 2u);
+		t = heap_buffer.data();
+	}
+	for (auto i = 0u; i < 2u * k + 2u; ++i) t[i] = 0ull;
+
+	/*
+	row i works on t + i, so limb i is reduced to zero and left behind
+	instead of shifting t down every row. both halves of a row are
+	limbs_addmul_1 calls and get its fastest version
+	*/
+	for (auto i = 0u; i < k; ++i){
+		// t += a * b[i]
+		carry = limbs_addmul_1(t + i, a, k, b[i]);
+		carry_flag = _addcarry_u64(0u, t[i + k], carry, &t[i + k]);
+		t[i + k + 1u] += carry_flag;
+
+		// pick m so that limb i of t + m * n is zero
+		m = t[i] * n0_inv;
+
+		// t += m * n
+		carry = limbs_addmul_1(t + i, n, k, m);
+		carry_flag = _addcarry_u64(0u, t[i + k], carry, &t[i + k]);
+		t[i + k + 1u] += carry_flag;
+	}
+
+	// u = t / 2^(64k) < 2n, one conditional subtraction finishes the reduction.
+	// a borrow that u[k] does not absorb means u was already less than n
+	u = t + k;
+	carry_flag = limbs_sub(r, u, k, n, k);
+	if (carry_flag && !u[k])
+		for (auto i = 0u; i < k; ++i) r[i] = u[i];
+}
+
+void limbs_mont_redc(uint64_t* r, uint64_t* t, const uint64_t* n, uint16_t k, uint64_t n0_inv){
+	uint64_t m;
+	uint8_t carry_flag;
+
+	/*
+	row i leaves limb i of t at zero. rows after it start higher up and
+	never touch it again, so the carry out of row i, which belongs at
+	limb i + k, is kept there
+	*/
+	for (auto i = 0u; i < k; ++i){
+		m = t[i] * n0_inv;
+		t[i] = limbs_addmul_1(t + i, n, k, m);
+	}
+
+	// t / 2^(64k) < 2n, one conditional subtraction finishes the reduction.
+	// the carry out of the sum is the bit that the subtraction borrows back
+	carry_flag = limbs_add(r, t + k, k, t, k);
+	if (carry_flag || limbs_cmp(r, n, k) >= 0) limbs_sub(r, r, k, n, k);
+}
+
+void limbs_mont_sqr(uint64_t* r, const uint64_t* a, const uint64_t* n, uint16_t k, uint64_t n0_inv){
+	uint64_t stack_buffer[2u * LIMBS_STACK_MAX];
+	std::vector<uint64_t> heap_buffer;
+	uint64_t* t;
+
+	if (k <= LIMBS_STACK_MAX) t = stack_buffer;
+	else{
+		heap_buffer.resize(2u * k);
+		t = heap_buffer.data();
+	}
+
+	limbs_sqr(t, a, k);
+	limbs_mont_redc(r, t, n, k, n0_inv);
+}
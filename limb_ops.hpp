@@ -0,0 +1,505 @@
+#pragma once
+
+#include <cstdint>
+#include <immintrin.h>
+
+#include "intrinsics.hpp"
+
+/*
+
+low level kernels for the arithmetic in uint_t.
+
+every kernel works on little-endian arrays of 64 bit limbs (index 0 is the
+least significant limb). lengths are given in limbs and only the limbs that
+are passed in are read or written, so callers can skip high limbs that are zero.
+
+*/
+
+/*
+operands where both have at least this many limbs are multiplied with
+karatsuba, smaller ones with the schoolbook basecase.
+bench/karatsuba_crossover.cpp measures where the crossover is. with the
+ADX basecase one level of karatsuba was 15-30% slower from 16 to about
+40 limbs, broke even around 48 and won by 2-15% from 50 to 64.
+override at compile time with -DKARATSUBA_THRESHOLD=<limbs>
+*/
+#ifndef KARATSUBA_THRESHOLD
+#define KARATSUBA_THRESHOLD 48u
+#endif
+
+/*
+the same for squaring. the basecase square does about half the multiplies
+of the basecase product, so karatsuba pays off much later. on the machines
+bench/karatsuba_crossover.cpp was run on it did not win below 64 limbs,
+so uint_t squares never take the karatsuba path with the default.
+override at compile time with -DKARATSUBA_SQR_THRESHOLD=<limbs>
+*/
+#ifndef KARATSUBA_SQR_THRESHOLD
+#define KARATSUBA_SQR_THRESHOLD 80u
+#endif
+
+/*
+kernels keep their temporaries on the stack for operands up to this many
+limbs and fall back to the heap above it
+*/
+#define LIMBS_STACK_MAX 128u
+
+/*
+number of scratch limbs limbs_mul_karatsuba needs for operands of n limbs
+*/
+#define KARATSUBA_SCRATCH(n) (4u * (n) + 64u)
+
+/*
+the copy, bitwise, comparison and shift kernels have an AVX-512 and an
+AVX2 version next to the scalar loop. the widest one the compiler targets
+is picked at compile time (__AVX512F__ / __AVX2__, set by -mavx512f, -mavx2,
+-march=native or /arch:AVX2 and /arch:AVX512), the scalar loop otherwise
+*/
+#if defined(__AVX512F__)
+#define LIMBS_SIMD_NAME "avx512"
+#elif defined(__AVX2__)
+#define LIMBS_SIMD_NAME "avx2"
+#else
+#define LIMBS_SIMD_NAME "scalar"
+#endif
+
+// --- copy / bitwise ---
+
+/*
+limbs_copy
+
+r[0..n) = a[0..n). r and a must not overlap.
+*/
+void limbs_copy(uint64_t* r, const uint64_t* a, uint16_t n);
+
+/*
+limbs_zero
+
+r[0..n) = 0
+*/
+void limbs_zero(uint64_t* r, uint16_t n);
+
+/*
+limbs_and, limbs_or, limbs_xor
+
+r[0..n) = a[0..n) op b[0..n)
+r may be the same array as a or b.
+*/
+void limbs_and(uint64_t* r, const uint64_t* a, const uint64_t* b, uint16_t n);
+void limbs_or(uint64_t* r, const uint64_t* a, const uint64_t* b, uint16_t n);
+void limbs_xor(uint64_t* r, const uint64_t* a, const uint64_t* b, uint16_t n);
+
+/*
+limbs_not
+
+r[0..n) = ~a[0..n)
+r may be the same array as a.
+*/
+void limbs_not(uint64_t* r, const uint64_t* a, uint16_t n);
+
+// --- comparison ---
+
+/*
+limbs_cmp
+
+compares a[0..n) with b[0..n).
+returns a negative number if a < b, 0 if they are equal and a positive
+number if a > b. whole vectors of limbs are compared at once starting at
+the top, only the first vector that differs is looked at limb by limb.
+*/
+int limbs_cmp(const uint64_t* a, const uint64_t* b, uint16_t n);
+
+// --- shifts ---
+
+/*
+limbs_shl
+
+r[0..n) = a[0..n) << bits, for bits < 64.
+returns the bits shifted out of the top of r.
+every limb is built from its own limb and the one below it, the vector
+versions load both as two overlapping vectors one limb apart.
+r may be the same array as a or start above it.
+*/
+uint64_t limbs_shl(uint64_t* r, const uint64_t* a, uint16_t n, uint16_t bits);
+
+/*
+limbs_shr
+
+r[0..n) = a[0..n) >> bits, for bits < 64. zeros are shifted in at the top.
+r may be the same array as a or start below it.
+*/
+void limbs_shr(uint64_t* r, const uint64_t* a, uint16_t n, uint16_t bits);
+
+// --- addition / subtraction ---
+
+/*
+limbs_add
+
+r[0..na) = a[0..na) + b[0..nb), requires na >= nb.
+returns the carry out of the top of r.
+r may be the same array as a or b.
+*/
+uint8_t limbs_add(uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb);
+
+/*
+limbs_sub
+
+r[0..na) = a[0..na) - b[0..nb), requires na >= nb.
+returns the borrow out of the top of r.
+r may be the same array as a or b.
+*/
+uint8_t limbs_sub(uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb);
+
+// --- multiplication ---
+
+/*
+limbs_mul_1
+
+r[0..n) = a[0..n) * b
+returns the limb that carries out of the top of r.
+r and a may be the same array.
+*/
+uint64_t limbs_mul_1(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b);
+
+/*
+limbs_addmul_1
+
+r[0..n) += a[0..n) * b
+returns the limb that carries out of the top of r.
+the first call checks the cpu with cpuid and every call after that goes to
+limbs_addmul_1_adx if it has ADX and BMI2, to limbs_addmul_1_generic if not.
+*/
+uint64_t limbs_addmul_1(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b);
+
+/*
+the two versions limbs_addmul_1 picks from.
+the generic one is a single carry chain of adds.
+the adx one is inline assembly (GCC / Clang) with mulx for the products
+and two carry chains that run side by side, adcx adding the low limbs
+through CF and adox the high limbs through OF. it must only run on a
+cpu with ADX and BMI2, and falls back to the generic one under MSVC.
+*/
+uint64_t limbs_addmul_1_generic(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b);
+uint64_t limbs_addmul_1_adx(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b);
+
+/*
+returns "adx" or "generic", the version limbs_addmul_1 uses on this cpu
+*/
+const char* limbs_addmul_1_name();
+
+/*
+limbs_submul_1
+
+r[0..n) -= a[0..n) * b
+returns the limb that borrows out of the top of r.
+*/
+uint64_t limbs_submul_1(uint64_t* r, const uint64_t* a, uint16_t n, uint64_t b);
+
+/*
+limbs_mul_basecase
+
+r[0..na + nb) = a[0..na) * b[0..nb)
+schoolbook multiplication, one row of 64x64->128 multiplies per limb of the
+shorter operand. na and nb must both be at least 1.
+r must not overlap a or b.
+*/
+void limbs_mul_basecase(uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb);
+
+/*
+limbs_mul_karatsuba
+
+r[0..2n) = a[0..n) * b[0..n)
+splits both operands in half and does three half size multiplications
+instead of four. recurses until the halves are below 'threshold' limbs,
+then uses the basecase.
+scratch must hold KARATSUBA_SCRATCH(n) limbs.
+r must not overlap a, b or scratch.
+*/
+void limbs_mul_karatsuba(uint64_t* r, const uint64_t* a, const uint64_t* b, uint16_t n,
+	uint64_t* scratch, uint16_t threshold = KARATSUBA_THRESHOLD);
+
+/*
+limbs_mul
+
+r[0..na + nb) = a[0..na) * b[0..nb)
+picks karatsuba when both operands are at least KARATSUBA_THRESHOLD limbs,
+the basecase otherwise.
+r must not overlap a or b.
+*/
+void limbs_mul(uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb);
+
+/*
+limbs_sqr_basecase
+
+r[0..2n) = a[0..n)^2
+every cross product a[i] * a[j] with i < j shows up twice in the square,
+so the triangle above the diagonal is summed once (n(n - 1) / 2 multiplies
+instead of n^2), doubled, and the n squares a[i]^2 are added on the
+diagonal in the same pass. n must be at least 1.
+r must not overlap a.
+*/
+void limbs_sqr_basecase(uint64_t* r, const uint64_t* a, uint16_t n);
+
+/*
+limbs_sqr_karatsuba
+
+r[0..2n) = a[0..n)^2
+karatsuba with three half size squares. recurses until the halves are
+below 'threshold' limbs, then uses the basecase square.
+scratch must hold KARATSUBA_SCRATCH(n) limbs.
+r must not overlap a or scratch.
+*/
+void limbs_sqr_karatsuba(uint64_t* r, const uint64_t* a, uint16_t n,
+	uint64_t* scratch, uint16_t threshold = KARATSUBA_SQR_THRESHOLD);
+
+/*
+limbs_sqr
+
+r[0..2n) = a[0..n)^2
+picks karatsuba when a is at least KARATSUBA_SQR_THRESHOLD limbs,
+the basecase square otherwise.
+r must not overlap a.
+*/
+void limbs_sqr(uint64_t* r, const uint64_t* a, uint16_t n);
+
+// --- division ---
+
+/*
+limbs_divmod_1
+
+q[0..n) = a[0..n) / d
+returns a[0..n) % d. d must not be zero.
+q may be the same array as a.
+*/
+uint64_t limbs_divmod_1(uint64_t* q, const uint64_t* a, uint16_t n, uint64_t d);
+
+/*
+limbs_reciprocal_1
+
+returns floor((2^128 - 1) / d) - 2^64, the reciprocal that
+limbs_divmod_1_preinv divides with. d must have its top bit set.
+*/
+uint64_t limbs_reciprocal_1(uint64_t d);
+
+/*
+limbs_divmod_1_preinv
+
+same as limbs_divmod_1, but every quotient limb is found with a multiply by
+the precomputed reciprocal of the divisor instead of a div instruction
+(moller and granlund, "improved division by invariant integers").
+d is the divisor shifted left by 'shift' so that its top bit is set,
+v = limbs_reciprocal_1(d). the returned remainder is not shifted.
+q may be nullptr if only the remainder is wanted, or the same array as a.
+*/
+uint64_t limbs_divmod_1_preinv(uint64_t* q, const uint64_t* a, uint16_t n, uint64_t d, uint8_t shift, uint64_t v);
+
+/*
+limbs_divmod
+
+q[0..na - nb + 1) = a[0..na) / b[0..nb)
+r[0..nb) = a[0..na) % b[0..nb)
+knuth's algorithm D (TAOCP vol 2, 4.3.1): the divisor is shifted so its top
+bit is set, and each quotient limb is estimated with one 128/64 division of
+the leading limbs, corrected at most twice.
+requires na >= nb and b[nb - 1] != 0. q may be nullptr if only the
+remainder is wanted. q and r must not overlap a or b.
+*/
+void limbs_divmod(uint64_t* q, uint64_t* r, const uint64_t* a, uint16_t na, const uint64_t* b, uint16_t nb);
+
+// --- montgomery ---
+
+/*
+limbs_mont_mul
+
+r[0..k) = a * b * 2^(-64k) mod n[0..k)
+coarsely integrated operand scanning (CIOS): every row of a * b[i] is
+followed by one limb of montgomery reduction. each row is added one limb
+further up a 2k + 2 limb buffer, so the reduced limbs are left behind
+instead of shifted out. n must be odd, n0_inv = -n^-1 mod 2^64, and a and b
+must be less than n. the result is fully reduced.
+r may be the same array as a or b.
+*/
+void limbs_mont_mul(uint64_t* r, const uint64_t* a, const uint64_t* b,
+	const uint64_t* n, uint16_t k, uint64_t n0_inv);
+
+/*
+limbs_mont_redc
+
+r[0..k) = t[0..2k) * 2^(-64k) mod n[0..k)
+montgomery reduction of a finished product (separated operand scanning).
+row i adds the multiple of n that zeroes limb i of t, and parks its carry
+in that limb, so the carries are added to the top half in one pass at the
+end instead of being rippled up after every row.
+n must be odd, n0_inv = -n^-1 mod 2^64 and t must be less than
+n * 2^(64k). the result is fully reduced. t is overwritten.
+r must not overlap t.
+*/
+void limbs_mont_redc(uint64_t* r, uint64_t* t, const uint64_t* n, uint16_t k, uint64_t n0_inv);
+
+/*
+limbs_mont_sqr
+
+r[0..k) = a^2 * 2^(-64k) mod n[0..k)
+limbs_sqr followed by limbs_mont_redc. the square saves close to half of
+the k^2 multiplies of the product, so this is about a quarter cheaper
+than limbs_mont_mul(r, a, a, ...). same requirements as limbs_mont_mul.
+r may be the same array as a.
+*/
+void limbs_mont_sqr(uint64_t* r, const uint64_t* a, const uint64_t* n, uint16_t k, uint64_t n0_inv);
+
+// --- fixed length ---
+
+/*
+uint_t widths of up to this many limbs (512 bits by default) use the
+fixed length kernels below instead of the runtime length ones above.
+below that the call, the loop counter and the length checks are a large
+part of the work, above it the unrolled code only grows.
+override at compile time with -DLIMBS_FIXED_MAX=<limbs>, 0 turns them off
+*/
+#ifndef LIMBS_FIXED_MAX
+#define LIMBS_FIXED_MAX 8u
+#endif
+
+/*
+the unrolled montgomery multiply has its own, lower limit. it beat the
+ADX limbs_mont_mul up to 5 limbs (2.5x at 2, 1.2x at 4), tied at 6 and was
+40% slower at 8, where its accumulator no longer fits in registers.
+it also beat limbs_mont_sqr up to 4 limbs, so it is used for squares too.
+override at compile time with -DLIMBS_FIXED_MONT_MAX=<limbs>
+*/
+#ifndef LIMBS_FIXED_MONT_MAX
+#define LIMBS_FIXED_MONT_MAX 4u
+#endif
+
+/*
+gcc and clang only unroll the loops of the fixed length kernels part of
+the way on their own (at 8 limbs gcc left limbs_mont_mul_n half a loop),
+this asks for all of it. msvc has no equivalent pragma
+*/
+#if defined(__GNUC__)
+#define LIMBS_UNROLL _Pragma("GCC unroll 16")
+#else
+#define LIMBS_UNROLL
+#endif
+
+/*
+limbs_add_n, limbs_sub_n
+
+the same as limbs_add(r, a, N, b, N) and limbs_sub(r, a, N, b, N) with the
+length known at compile time. defined here so every use inlines and the
+loop unrolls into a straight adc / sbb chain.
+r may be the same array as a or b.
+*/
+template <uint16_t N>
+inline uint8_t limbs_add_n(uint64_t* r, const uint64_t* a, const uint64_t* b){
+	uint8_t carry_flag = 0u;
+
+	LIMBS_UNROLL
+	for (auto i = 0u; i < N; ++i)
+		carry_flag = _addcarry_u64(carry_flag, a[i], b[i], &r[i]);
+	return carry_flag;
+}
+
+template <uint16_t N>
+inline uint8_t limbs_sub_n(uint64_t* r, const uint64_t* a, const uint64_t* b){
+	uint8_t borrow_flag = 0u;
+
+	LIMBS_UNROLL
+	for (auto i = 0u; i < N; ++i)
+		borrow_flag = _subborrow_u64(borrow_flag, a[i], b[i], &r[i]);
+	return borrow_flag;
+}
+
+/*
+limbs_mullo_n
+
+r[0..N) = a[0..N) * b[0..N) mod 2^(64N)
+only the products that land in the low N limbs, N (N + 1) / 2 multiplies
+instead of the N^2 of the full product. the truncated product uint_t keeps
+when a product does not fit.
+r must not overlap a or b.
+*/
+template <uint16_t N>
+inline void limbs_mullo_n(uint64_t* r, const uint64_t* a, const uint64_t* b){
+	uint64_t lo, hi, carry;
+	uint8_t carry_flag;
+
+	for (auto i = 0u; i < N; ++i) r[i] = 0ull;
+
+	// row j adds a * b[j] from limb j up, cut off at limb N
+	LIMBS_UNROLL
+	for (auto j = 0u; j < N; ++j){
+		carry = 0ull;
+		LIMBS_UNROLL
+		for (auto i = 0u; i + j < N; ++i){
+			// intrinsic function
+			// mul instruction
+			// hi:lo = a[i] * b[j]
+			lo = _umul128(a[i], b[j], &hi);
+
+			carry_flag = _addcarry_u64(0u, lo, carry, &lo);
+			hi += carry_flag;
+			carry_flag = _addcarry_u64(0u, lo, r[i + j], &r[i + j]);
+			carry = hi + carry_flag;
+		}
+	}
+}
+
+/*
+limbs_mont_mul_n
+
+limbs_mont_mul with k = N known at compile time. the classic CIOS form
+with an N + 2 limb accumulator that is shifted down one limb per row, small
+enough for the compiler to keep most of it in registers.
+same requirements as limbs_mont_mul, r may be the same array as a or b.
+*/
+template <uint16_t N>
+inline void limbs_mont_mul_n(uint64_t* r, const uint64_t* a, const uint64_t* b, const uint64_t* n, uint64_t n0_inv){
+	uint64_t t[N + 2u];
+	uint64_t lo, hi, carry, m;
+	uint8_t carry_flag;
+
+	for (auto i = 0u; i < N + 2u; ++i) t[i] = 0ull;
+
+	LIMBS_UNROLL
+	for (auto i = 0u; i < N; ++i){
+		// t += a * b[i]
+		carry = 0ull;
+		LIMBS_UNROLL
+		for (auto j = 0u; j < N; ++j){
+			// intrinsic function
+			// mul instruction
+			// hi:lo = a[j] * b[i]
+			lo = _umul128(a[j], b[i], &hi);
+
+			carry_flag = _addcarry_u64(0u, lo, carry, &lo);
+			hi += carry_flag;
+			carry_flag = _addcarry_u64(0u, lo, t[j], &t[j]);
+			carry = hi + carry_flag;
+		}
+		carry_flag = _addcarry_u64(0u, t[N], carry, &t[N]);
+		t[N + 1u] = carry_flag;
+
+		// t = (t + m * n) / 2^64, m picked so that the low limb becomes zero
+		m = t[0] * n0_inv;
+		lo = _umul128(n[0], m, &hi);
+		carry_flag = _addcarry_u64(0u, lo, t[0], &lo);
+		carry = hi + carry_flag;
+		LIMBS_UNROLL
+		for (auto j = 1u; j < N; ++j){
+			lo = _umul128(n[j], m, &hi);
+
+			carry_flag = _addcarry_u64(0u, lo, carry, &lo);
+			hi += carry_flag;
+			carry_flag = _addcarry_u64(0u, lo, t[j], &t[j - 1u]);
+			carry = hi + carry_flag;
+		}
+		carry_flag = _addcarry_u64(0u, t[N], carry, &t[N - 1u]);
+		t[N] = t[N + 1u] + carry_flag;
+	}
+
+	// t < 2n, the same conditional subtraction as limbs_mont_mul
+	carry_flag = limbs_sub_n<N>(r, t, n);
+	if (carry_flag && !t[N])
+		for (auto i = 0u; i < N; ++i) r[i] = t[i];
+}
@@ -4,19 +4,42 @@
 #include <iostream>
 #include <string>
 
+#include "instrument.hpp"
+#include "prime_search.hpp"
 #include "primality_tests.hpp"
+#include "random.hpp"
+#include "rsa.hpp"
 #include "uint2048.hpp"
 
+/*
+prints what the instrumented build counted, one line per operation that
+was called and where the primality tests rejected their candidates
+*/
+static void print_instrument(const InstrumentSnapshot& snapshot){
+	for (auto op = 0u; op < static_cast<uint8_t>(InstrumentOp::count); ++op){
+		const auto& stats = snapshot.ops[op];
+
+		if (!stats.calls) continue;
+		printf("%-10s %12llu calls %14llu limbs %10.1f cycles / call\n", instrument_op_name(static_cast<InstrumentOp>(op)),
+			(unsigned long long)stats.calls, (unsigned long long)stats.limbs, (double)stats.cycles / stats.calls);
+	}
+
+	const auto& mr = snapshot.miller_rabin;
+	printf("primality tests %llu: %llu trivial, %llu trial division, %llu round 0, %llu later rounds, %llu passed\n",
+		(unsigned long long)mr.tests, (unsigned long long)mr.trivial, (unsigned long long)mr.trial_division,
+		(unsigned long long)mr.rounds[0], (unsigned long long)(mr.tests - mr.trivial - mr.trial_division - mr.rounds[0] - mr.passed),
+		(unsigned long long)mr.passed);
+}
 
 int main(){
 	std::seed_seq s{ 1u, (unsigned)std::chrono::system_clock::now().time_since_epoch().count() };
 	std::mt19937_64 r{ s };
+	SecureRandom secure;
 
 	uint2048 num_a, num_b;
 	uint2048 num_c;
 
 	uint2048 p, q, n;
-	uint2048 totient;
 	uint2048 e;
 
 
@@ -26,19 +49,23 @@ int main(){
 	//std::cout << num_a.to_bitset().to_ullong() << std::endl;
 
 
-	if (!(num_a & 1ull)){
-		++num_a;
-	}
-	
-	auto is = false;
-	while (!is){
-		std::cout << (is = miller_rabin_test(num_a, 10, &r)) << std::endl;
-		if (is) break;
-		num_a += 2ull;
-	}
+	// the candidates come from the system generator, a prime like this can become a key
+	num_a = find_prime<2048u>(1024u, 0u, 0u, &secure);
+	std::cout << bpsw_test(num_a) << std::endl;
+	if (instrument_enabled()) print_instrument(instrument_snapshot());
+
+
+	std::cout << num_a.to_string() << std::endl;
 
+	// 2048 bit key, num_b round trips through the public and private operations
+	auto key = RsaKey<2048u>::generate(&secure);
+	p = uint2048{ key.p() };
+	q = uint2048{ key.q() };
+	n = key.n();
+	e = key.e();
 
-	std::cout << (num_a).to_bitset() << std::endl;
+	num_c = key.public_op(num_b);
+	std::cout << (key.private_op(num_c) == num_b) << std::endl;
 
 	printf("ding!\n");
 	std::cin.ignore(1000, '\n');
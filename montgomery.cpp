@@ -0,0 +1,107 @@
+#include "montgomery.hpp"
+
+#include <stdexcept>
+
+#include "instrument.hpp"
+#include "limb_ops.hpp"
+
+// --- constructors ---
+
+template <uint16_t Bits>
+MontgomeryContext<Bits>::MontgomeryContext(const uint_t<Bits>& modulus){
+	if (!(modulus & 1ull)) throw std::invalid_argument("MontgomeryContext: modulus must be odd");
+
+	uint64_t inv, n0;
+	uint_t<Bits> temp;
+	uint8_t carry_flag, borrow_flag;
+
+	modulus_ = modulus;
+	size_ = modulus.num_limbs();
+
+	/*
+	newton iteration for the inverse of n mod 2^64.
+	an odd n is its own inverse mod 2^3 and every step doubles the
+	number of correct bits: 3, 6, 12, 24, 48, 96
+	*/
+	n0 = modulus.parts_[0];
+	inv = n0;
+	for (auto i = 0u; i < 5u; ++i) inv *= 2ull - n0 * inv;
+	n0_inv_ = 0ull - inv;
+
+	/*
+	get R mod n and R^2 mod n by doubling 1 until it reaches 2^(128k),
+	reducing after every step.
+	only done once per modulus, so it is fine for it to be slow-ish
+	*/
+	r_squared_ = (modulus == 1ull) ? 0ull : 1ull;
+	for (auto i = 0u; i < 128u * size_; ++i){
+		if (i == 64u * size_) one_ = r_squared_;
+
+		carry_flag = limbs_add(r_squared_.parts_, r_squared_.parts_, size_, r_squared_.parts_, size_);
+		borrow_flag = limbs_sub(temp.parts_, r_squared_.parts_, size_, modulus_.parts_, size_);
+		if (carry_flag || !borrow_flag) r_squared_ = temp;
+		r_squared_.trim(size_);
+	}
+}
+
+// --- functions ---
+
+template <uint16_t Bits>
+uint_t<Bits> MontgomeryContext<Bits>::to_mont(const uint_t<Bits>& num) const{
+	return mont_mul(num, r_squared_);
+}
+
+template <uint16_t Bits>
+uint_t<Bits> MontgomeryContext<Bits>::from_mont(const uint_t<Bits>& num) const{
+	return mont_mul(num, 1ull);
+}
+
+template <uint16_t Bits>
+uint_t<Bits> MontgomeryContext<Bits>::mont_mul(const uint_t<Bits>& a, const uint_t<Bits>& b) const{
+	BIGNUM_INSTRUMENT_SCOPE(mont_mul, 2u * size_);
+
+	uint_t<Bits> ret;
+
+	// a full width modulus of a small width gets the unrolled kernel
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MONT_MAX){
+		if (size_ == uint_t<Bits>::Limbs){
+			limbs_mont_mul_n<uint_t<Bits>::Limbs>(ret.parts_, a.parts_, b.parts_, modulus_.parts_, n0_inv_);
+			ret.trim(size_);
+			return ret;
+		}
+	}
+
+	limbs_mont_mul(ret.parts_, a.parts_, b.parts_, modulus_.parts_, size_, n0_inv_);
+	ret.trim(size_);
+	return ret;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> MontgomeryContext<Bits>::mont_sqr(const uint_t<Bits>& a) const{
+	BIGNUM_INSTRUMENT_SCOPE(mont_sqr, size_);
+
+	uint_t<Bits> ret;
+
+	// at these widths the unrolled multiply is faster than the square
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MONT_MAX){
+		if (size_ == uint_t<Bits>::Limbs){
+			limbs_mont_mul_n<uint_t<Bits>::Limbs>(ret.parts_, a.parts_, a.parts_, modulus_.parts_, n0_inv_);
+			ret.trim(size_);
+			return ret;
+		}
+	}
+
+	limbs_mont_sqr(ret.parts_, a.parts_, modulus_.parts_, size_, n0_inv_);
+	ret.trim(size_);
+	return ret;
+}
+
+// --- instantiations ---
+
+template class MontgomeryContext<256u>;
+template class MontgomeryContext<512u>;
+template class MontgomeryContext<1024u>;
+template class MontgomeryContext<1536u>;
+template class MontgomeryContext<2048u>;
+template class MontgomeryContext<3072u>;
+template class MontgomeryContext<4096u>;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+#include "uint2048.hpp"
+
+/*
+
+MontgomeryContext
+
+precomputes everything needed for montgomery multiplication under one fixed
+odd modulus n. with R = 2^(64k), k being the number of limbs n uses, numbers
+are kept in montgomery form (x * R mod n) so that products can be reduced
+with multiplies and shifts instead of a division.
+
+build one per modulus and reuse it for every multiplication under it.
+a modulus that fills a width of up to LIMBS_FIXED_MONT_MAX limbs
+(limb_ops.hpp, 256 bits by default) is multiplied and squared with a
+kernel unrolled for that width.
+instantiated in montgomery.cpp for the same widths as uint_t.
+
+*/
+template <uint16_t Bits>
+class MontgomeryContext{
+private:
+	uint_t<Bits> modulus_;
+	uint_t<Bits> one_;       // R mod n, the montgomery form of 1
+	uint_t<Bits> r_squared_; // R^2 mod n
+	uint64_t n0_inv_;    // -n^-1 mod 2^64
+	uint16_t size_;      // k, the number of limbs in n
+
+public:
+
+	// --- constructors ---
+
+	/*
+	precomputes R^2 mod n and -n^-1 mod 2^64.
+	throws std::invalid_argument if the modulus is even
+	*/
+	MontgomeryContext(const uint_t<Bits>& modulus);
+
+	// --- functions ---
+
+	const uint_t<Bits>& modulus() const{ return modulus_; }
+
+	/*
+	returns 1 in montgomery form
+	*/
+	const uint_t<Bits>& one() const{ return one_; }
+
+	/*
+	converts num into montgomery form.
+	num must be less than the modulus
+	*/
+	uint_t<Bits> to_mont(const uint_t<Bits>& num) const;
+
+	/*
+	converts num out of montgomery form
+	*/
+	uint_t<Bits> from_mont(const uint_t<Bits>& num) const;
+
+	/*
+	multiplies two numbers in montgomery form.
+	returns a * b * R^-1 mod n, which is the montgomery form of the product
+	*/
+	uint_t<Bits> mont_mul(const uint_t<Bits>& a, const uint_t<Bits>& b) const;
+
+	/*
+	squares a number in montgomery form, the same as mont_mul(a, a) for
+	about a quarter less work
+	*/
+	uint_t<Bits> mont_sqr(const uint_t<Bits>& a) const;
+
+};
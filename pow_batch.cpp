@@ -0,0 +1,311 @@
+#include "pow_batch.hpp"
+
+#include <immintrin.h>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX512F__) && defined(__AVX512IFMA__)
+#define POW_BATCH_LANES 1
+
+/*
+8 lanes of 52 bit digits.
+the 104 bit product of two digits is added in two halves, the low 52 bits
+to the digit it belongs to and the high 52 bits to the one above
+*/
+struct BatchLanes{
+	using V = __m512i;
+	using M = __mmask8;
+
+	static constexpr uint16_t Lanes = 8u;
+	static constexpr uint16_t DigitBits = 52u;
+
+	static V zero(){ return _mm512_setzero_si512(); }
+	static V set1(uint64_t x){ return _mm512_set1_epi64(static_cast<long long>(x)); }
+	static V load(const uint64_t* x){ return _mm512_loadu_si512(x); }
+	static void store(uint64_t* r, V x){ _mm512_storeu_si512(r, x); }
+
+	static V add(V a, V b){ return _mm512_add_epi64(a, b); }
+	static V low(V a){ return _mm512_and_si512(a, set1((1ull << DigitBits) - 1ull)); }
+	// zero masked with every lane set, as in limbs_shl: the unmasked form
+	// passes an undefined vector through that gcc 12 warns about
+	static V high(V a){ return _mm512_maskz_srli_epi64(0xff, a, DigitBits); }
+
+	// digit 0 of acc += lo(a * b), digit 1 += hi(a * b)
+	static void mul_acc(uint64_t* acc, V a, V b){
+		store(acc, _mm512_madd52lo_epu64(load(acc), a, b));
+		store(acc + Lanes, _mm512_madd52hi_epu64(load(acc + Lanes), a, b));
+	}
+	// a * b mod 2^52, a may have more than 52 bits
+	static V mul_low(V a, V b){ return _mm512_madd52lo_epu64(zero(), a, b); }
+
+	static M eq(V a, V b){ return _mm512_cmpeq_epu64_mask(a, b); }
+	static V blend(M mask, V a, V b){ return _mm512_mask_blend_epi64(mask, a, b); }
+};
+
+#elif defined(__AVX2__)
+#define POW_BATCH_LANES 1
+
+/*
+4 lanes of 26 bit digits.
+vpmuludq multiplies the low 32 bits of every lane, the 52 bit product is
+added to the digit it belongs to whole and carried out later
+*/
+struct BatchLanes{
+	using V = __m256i;
+	using M = __m256i;
+
+	static constexpr uint16_t Lanes = 4u;
+	static constexpr uint16_t DigitBits = 26u;
+
+	static V zero(){ return _mm256_setzero_si256(); }
+	static V set1(uint64_t x){ return _mm256_set1_epi64x(static_cast<long long>(x)); }
+	static V load(const uint64_t* x){ return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x)); }
+	static void store(uint64_t* r, V x){ _mm256_storeu_si256(reinterpret_cast<__m256i*>(r), x); }
+
+	static V add(V a, V b){ return _mm256_add_epi64(a, b); }
+	static V low(V a){ return _mm256_and_si256(a, set1((1ull << DigitBits) - 1ull)); }
+	static V high(V a){ return _mm256_srli_epi64(a, DigitBits); }
+
+	// digit 0 of acc += a * b
+	static void mul_acc(uint64_t* acc, V a, V b){ store(acc, _mm256_add_epi64(load(acc), _mm256_mul_epu32(a, b))); }
+	// a * b mod 2^26, a may have more than 26 bits
+	static V mul_low(V a, V b){ return low(_mm256_mul_epu32(a, b)); }
+
+	static M eq(V a, V b){ return _mm256_cmpeq_epi64(a, b); }
+	static V blend(M mask, V a, V b){
+		return _mm256_castpd_si256(_mm256_blendv_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _mm256_castsi256_pd(mask)));
+	}
+};
+
+#endif
+
+#ifdef POW_BATCH_LANES
+
+/*
+digits of up to L::Lanes values side by side, digit j of every lane in the
+L::Lanes words at operator[](j), starting on a 64 byte boundary.
+kept as uint64_t and moved in and out of registers with L::load / L::store,
+a std::vector of the vector type would drop its alignment (gcc warns that
+the attribute is ignored).
+resize zeroes the contents
+*/
+template <typename L>
+class BatchDigits{
+private:
+	std::vector<uint64_t> storage_;
+	uint64_t* data_ = nullptr;
+
+public:
+	void resize(uint32_t digits){
+		storage_.assign(digits * L::Lanes + 8u, 0ull);
+
+		// skip to the first 64 byte boundary, at most 7 words in
+		auto misalign = reinterpret_cast<uintptr_t>(storage_.data()) % 64u;
+		data_ = storage_.data() + (misalign ? (64u - misalign) / sizeof(uint64_t) : 0u);
+	}
+
+	uint64_t* operator[](uint32_t j){ return data_ + j * L::Lanes; }
+	const uint64_t* operator[](uint32_t j) const{ return data_ + j * L::Lanes; }
+};
+
+/*
+constants for one modulus, every digit holds the same value in every lane
+*/
+template <typename L>
+struct BatchModulus{
+	BatchDigits<L> n;         // digits of the modulus
+	BatchDigits<L> r_squared; // R^2 mod n, R = 2^(DigitBits * size)
+	BatchDigits<L> one;       // 1, not in montgomery form
+	uint64_t k0;              // -n^-1 mod 2^DigitBits
+	uint16_t size;            // number of digits
+};
+
+/*
+almost montgomery multiplication, r = a * b / R mod n, in every lane.
+a, b and r point at digit 0 of 'size' digits laid out as in BatchDigits.
+a and b are below 2n with normalized digits, and so is r.
+needs 4n < R, which the digit count is picked for.
+digit i of the product is added to digit i of acc and never carried
+right away. acc must hold 2 * size + 1 digits. r may be the same as a or b.
+*/
+template <typename L>
+static void amm(uint64_t* r, const uint64_t* a, const uint64_t* b, const BatchModulus<L>& mod, uint64_t* acc){
+	typename L::V b_i, q, k0, carry;
+	auto size = mod.size;
+
+	for (auto i = 0u; i < 2u * size + 1u; ++i) L::store(acc + i * L::Lanes, L::zero());
+
+	k0 = L::set1(mod.k0);
+	for (auto i = 0u; i < size; ++i){
+		auto row = acc + i * L::Lanes;
+
+		b_i = L::load(b + i * L::Lanes);
+		for (auto j = 0u; j < size; ++j) L::mul_acc(row + j * L::Lanes, L::load(a + j * L::Lanes), b_i);
+
+		// add q * n so the lowest digit becomes 0, then carry it into the next
+		q = L::mul_low(L::load(row), k0);
+		for (auto j = 0u; j < size; ++j) L::mul_acc(row + j * L::Lanes, L::load(mod.n[j]), q);
+		L::store(row + L::Lanes, L::add(L::load(row + L::Lanes), L::high(L::load(row))));
+	}
+
+	// the upper half is the result, normalize its digits
+	carry = L::zero();
+	for (auto j = 0u; j < size; ++j){
+		auto digit = L::add(L::load(acc + (size + j) * L::Lanes), carry);
+		L::store(r + j * L::Lanes, L::low(digit));
+		carry = L::high(digit);
+	}
+}
+
+/*
+digits of every lane's value, lanes past 'count' are 0
+*/
+template <typename L, uint16_t Bits>
+static void to_lanes(uint64_t* r, const uint_t<Bits>* values, uint32_t count, uint16_t size){
+	for (auto j = 0u; j < size; ++j){
+		for (auto k = 0u; k < L::Lanes; ++k)
+			r[j * L::Lanes + k] = (k < count) ? values[k].bits_at(j * L::DigitBits) & ((1ull << L::DigitBits) - 1ull) : 0ull;
+	}
+}
+
+template <typename L, uint16_t Bits>
+static void from_lanes(uint_t<Bits>* r, const uint64_t* x, uint32_t count, uint16_t size){
+	for (auto k = 0u; k < count; ++k) r[k] = 0ull;
+	for (auto j = size; j > 0u; --j){
+		for (auto k = 0u; k < count; ++k){
+			r[k] <<= L::DigitBits;
+			r[k] += x[(j - 1u) * L::Lanes + k];
+		}
+	}
+}
+
+template <typename L, uint16_t Bits>
+static void pow_mod_lanes(const uint_t<Bits>* bases, const uint_t<Bits>* exps, uint32_t count,
+	const uint_t<Bits>& mod, uint_t<Bits>* out){
+	BatchModulus<L> m;
+	BatchDigits<L> acc, x, result, select, table;
+	uint_t<Bits> values[L::Lanes];
+	uint_t<Bits> exponents[L::Lanes];
+	uint64_t n0, inv;
+	uint16_t size, exp_bits, window;
+
+	// 4n < R leaves room for the results of amm to stay below 2n
+	size = (mod.num_bits() + 2u + L::DigitBits - 1u) / L::DigitBits;
+	m.size = size;
+	m.n.resize(size);
+	m.r_squared.resize(size);
+	m.one.resize(size);
+
+	// newton iteration for n^-1 mod 2^64, the same as MontgomeryContext
+	n0 = mod.bits_at(0u);
+	inv = n0;
+	for (auto i = 0u; i < 5u; ++i) inv *= 2ull - n0 * inv;
+	m.k0 = (0ull - inv) & ((1ull << L::DigitBits) - 1ull);
+
+	for (auto j = 0u; j < size; ++j){
+		L::store(m.n[j], L::set1(mod.bits_at(j * L::DigitBits) & ((1ull << L::DigitBits) - 1ull)));
+		L::store(m.one[j], L::set1(j ? 0ull : 1ull));
+	}
+	{
+		uint_t<Bits> r_squared;
+
+		r_squared = pow_mod(uint_t<Bits>{ 2ull }, uint_t<Bits>{ 2ull * L::DigitBits * size }, mod);
+		for (auto j = 0u; j < size; ++j)
+			L::store(m.r_squared[j], L::set1(r_squared.bits_at(j * L::DigitBits) & ((1ull << L::DigitBits) - 1ull)));
+	}
+
+	// the table has room for the widest window
+	acc.resize(2u * size + 1u);
+	x.resize(size);
+	result.resize(size);
+	select.resize(size);
+	table.resize((1u << 5u) * size);
+
+	for (auto g = 0u; g < count; g += L::Lanes){
+		uint32_t lanes;
+
+		lanes = (count - g < L::Lanes) ? count - g : L::Lanes;
+
+		// read the whole group before writing any of it, out may alias the inputs
+		exp_bits = 0u;
+		for (auto k = 0u; k < lanes; ++k){
+			values[k] = (bases[g + k] < mod) ? bases[g + k] : bases[g + k] % mod;
+			exponents[k] = exps[g + k];
+			if (exponents[k].num_bits() > exp_bits) exp_bits = exponents[k].num_bits();
+		}
+
+		// same choice of width as for sliding windows, a bit narrower
+		// since every window costs a multiply here
+		window = (exp_bits > 512u) ? 5u : (exp_bits > 64u) ? 4u : 1u;
+
+		// table entry d, at digit d * size, is x^d in montgomery form
+		to_lanes<L>(x[0], values, lanes, size);
+		amm(x[0], x[0], m.r_squared[0], m, acc[0]);
+		amm(table[0], m.one[0], m.r_squared[0], m, acc[0]);
+		for (auto j = 0u; j < size; ++j) L::store(table[size + j], L::load(x[j]));
+		for (auto d = 2u; d < (1u << window); ++d)
+			amm(table[d * size], table[(d - 1u) * size], x[0], m, acc[0]);
+
+		for (auto j = 0u; j < size; ++j) L::store(result[j], L::load(table[j]));
+
+		// windows from the top, every lane takes the same steps
+		auto top = exp_bits ? (exp_bits - 1u) / window * window : 0u;
+		for (auto pos = top + window; pos > 0u;){
+			alignas(64) uint64_t digits[L::Lanes];
+
+			pos -= window;
+			for (auto k = 0u; k < L::Lanes; ++k)
+				digits[k] = (k < lanes) ? exponents[k].bits_at(pos) & ((1ull << window) - 1ull) : 0ull;
+			auto lane_digits = L::load(digits);
+
+			// the table entry every lane wants, picked without branches
+			for (auto j = 0u; j < size; ++j){
+				auto picked = L::load(table[j]);
+
+				for (auto d = 1u; d < (1u << window); ++d)
+					picked = L::blend(L::eq(lane_digits, L::set1(d)), picked, L::load(table[d * size + j]));
+				L::store(select[j], picked);
+			}
+
+			if (pos != top){
+				for (auto i = 0u; i < window; ++i) amm(result[0], result[0], result[0], m, acc[0]);
+			}
+			amm(result[0], result[0], select[0], m, acc[0]);
+		}
+
+		// out of montgomery form, amm by 1 leaves a result of at most n
+		amm(result[0], result[0], m.one[0], m, acc[0]);
+		from_lanes<L>(out + g, result[0], lanes, size);
+		for (auto k = 0u; k < lanes; ++k){
+			if (out[g + k] >= mod) out[g + k] -= mod;
+		}
+	}
+}
+
+#endif
+
+template <uint16_t Bits>
+void pow_mod_batch(const uint_t<Bits>* bases, const uint_t<Bits>* exps, uint32_t count,
+	const uint_t<Bits>& mod, uint_t<Bits>* out){
+	if (mod == 0ull) throw std::domain_error("uint_t: division by zero");
+
+#ifdef POW_BATCH_LANES
+	if ((mod & 1ull) && mod != 1ull){
+		pow_mod_lanes<BatchLanes>(bases, exps, count, mod, out);
+		return;
+	}
+#endif
+
+	for (auto i = 0u; i < count; ++i) out[i] = pow_mod(bases[i], exps[i], mod);
+}
+
+// --- instantiations ---
+
+template void pow_mod_batch(const uint_t<256u>*, const uint_t<256u>*, uint32_t, const uint_t<256u>&, uint_t<256u>*);
+template void pow_mod_batch(const uint_t<512u>*, const uint_t<512u>*, uint32_t, const uint_t<512u>&, uint_t<512u>*);
+template void pow_mod_batch(const uint_t<1024u>*, const uint_t<1024u>*, uint32_t, const uint_t<1024u>&, uint_t<1024u>*);
+template void pow_mod_batch(const uint_t<1536u>*, const uint_t<1536u>*, uint32_t, const uint_t<1536u>&, uint_t<1536u>*);
+template void pow_mod_batch(const uint_t<2048u>*, const uint_t<2048u>*, uint32_t, const uint_t<2048u>&, uint_t<2048u>*);
+template void pow_mod_batch(const uint_t<3072u>*, const uint_t<3072u>*, uint32_t, const uint_t<3072u>&, uint_t<3072u>*);
+template void pow_mod_batch(const uint_t<4096u>*, const uint_t<4096u>*, uint32_t, const uint_t<4096u>&, uint_t<4096u>*);
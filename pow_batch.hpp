@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include "uint2048.hpp"
+
+/*
+pow_mod_batch
+
+out[i] = bases[i]^exps[i] mod 'mod' for i in [0, count), every value under
+the same modulus.
+
+for an odd modulus the values are worked on several at a time, one per
+vector lane, in a structure of arrays layout: vector j holds digit j of
+every lane. each multiply is an almost montgomery multiplication that
+leaves the digits unnormalized until the end, so a whole batch of
+multiplies runs in lockstep without any per lane branches.
+	AVX-512 IFMA: 8 lanes of 52 bit digits, vpmadd52luq / vpmadd52huq
+	AVX2:         4 lanes of 26 bit digits, vpmuludq
+the path is picked at compile time (__AVX512IFMA__, __AVX2__).
+without either, or for an even modulus, every value goes through pow_mod.
+
+the exponents are processed with fixed windows of the same width in
+every lane, the table entry for each lane is picked with compares and
+blends, so the work done does not depend on the exponent bits.
+
+out may be the same array as bases or exps.
+throws std::domain_error if mod is zero.
+*/
+template <uint16_t Bits>
+void pow_mod_batch(const uint_t<Bits>* bases, const uint_t<Bits>* exps, uint32_t count,
+	const uint_t<Bits>& mod, uint_t<Bits>* out);
@@ -4,16 +4,21 @@
 #include <random>
 #include <vector>
 
+#include "instrument.hpp"
+#include "montgomery.hpp"
 #include "uint2048.hpp"
 
-// ! TODO needs input of k for accuracy of the test
+/*
+small_prime_factor
 
-bool miller_rabin_test(const uint2048& num, const unsigned accuracy, std::mt19937_64* mt_rand){
-
-	// make sure num is odd and greater than 3
-	if (!(num & 1ull) || (num <= 3ull)) return false;
-
-	std::vector<uint64_t> test =
+returns the first of the odd primes 3 .. 229 that divides num, 0 if none
+does. the primes are multiplied together in runs that still fit in 64 bits,
+one pass over num per product, then the remainder is checked against each
+prime of the run with plain 64 bit arithmetic
+*/
+template <uint16_t Bits>
+uint64_t small_prime_factor(const uint_t<Bits>& num){
+	static const std::vector<uint64_t> test =
 	{
 		3ull, 5ull, 7ull, 11ull,
 		13ull, 17ull, 19ull, 23ull, 29ull,
@@ -27,50 +32,255 @@ bool miller_rabin_test(const uint2048& num, const unsigned accuracy, std::mt1993
 		199ull, 211ull, 223ull, 227ull, 229ull
 	};
 
-	for (auto n : test){
-		if (num % n == 0ull) return false;
+	static const std::vector<U64Divisor> products = []{
+		std::vector<U64Divisor> ret;
+		auto product = 1ull;
+
+		for (auto n : test){
+			if (product > ~0ull / n){
+				ret.emplace_back(product);
+				product = 1ull;
+			}
+			product *= n;
+		}
+		ret.emplace_back(product);
+		return ret;
+	}();
+
+	auto next = 0u;
+	for (const auto& product : products){
+		auto rem = mod_u64(num, product);
+
+		for (; next < test.size() && product.divisor() % test[next] == 0ull; ++next){
+			if (rem % test[next] == 0ull) return test[next];
+		}
 	}
+	return 0ull;
+}
+
+/*
+strong_probable_prime
 
-	uint2048 a;
+one miller rabin round: true if num is a strong probable prime to 'base'.
+num must be odd and greater than base + 1, ctx built for num
+*/
+template <uint16_t Bits>
+bool strong_probable_prime(const uint_t<Bits>& num, const uint_t<Bits>& base, const MontgomeryContext<Bits>& ctx){
 	uint16_t s;
-	uint2048 d;
-	uint2048 x;
+	uint_t<Bits> d;
+	uint_t<Bits> x;
+	uint_t<Bits> minus_one;
 
-	s = 0u;
+	// num - 1 = d * 2^s with d odd
 	d = num - 1ull;
+	s = d.trailing_zeros();
+	d >>= s;
 
-	// while d is even
-	while (!(d & 1ull)){
-		d >>= 1u;
-		++s;
+	x = pow_mod(base, d, ctx);
+	if (x == 1ull || x == (num - 1ull)) return true;
+
+	// square in montgomery form from here on,
+	// 1 and num - 1 are compared against in montgomery form as well
+	minus_one = num - ctx.one();
+	x = ctx.to_mont(x);
+	for (auto i = 1u; i < s; ++i){
+		x = ctx.mont_sqr(x);
+		if (x == ctx.one()) return false;
+		if (x == minus_one) return true;
 	}
+	return false;
+}
+
+/*
+strong_lucas_probable_prime
+
+true if num is a strong lucas probable prime with selfridge's parameters
+(baillie and wagstaff, "lucas pseudoprimes", method A): D is the first of
+5, -7, 9, -11 ... with (D / num) = -1, P = 1 and Q = (1 - D) / 4.
+with num + 1 = d * 2^s, d odd, num passes if U_d = 0 or V_(d * 2^r) = 0
+for some 0 <= r < s.
+U_k and V_k are walked up the bits of d in montgomery form, doubling with
+U_2k = U_k * V_k, V_2k = V_k^2 - 2Q^k and stepping with
+U_k+1 = (U_k + V_k) / 2, V_k+1 = (D * U_k + V_k) / 2.
+num must be odd, greater than 229 and have no factor up to 229,
+ctx built for num
+*/
+template <uint16_t Bits>
+bool strong_lucas_probable_prime(const uint_t<Bits>& num, const MontgomeryContext<Bits>& ctx){
+	int64_t d_param, q_param;
+	uint16_t s;
+	int symbol;
+	uint_t<Bits> d, half_num;
+	uint_t<Bits> u, v, q_k;
+	uint_t<Bits> d_mont, q_mont;
+
+	// no D has (D / num) = -1 when num is a square, the search would not end
+	if (is_square(num)) return false;
+
+	d_param = 5;
+	for (;;){
+		symbol = jacobi(d_param, num);
+		if (symbol == -1) break;
+
+		// D and num share a factor, and num > |D|
+		if (symbol == 0) return false;
+		d_param = (d_param > 0) ? -(d_param + 2) : 2 - d_param;
+	}
+	q_param = (1 - d_param) / 4;
+
+	// small signed values mod num, then into montgomery form
+	auto residue = [&](int64_t value){
+		uint_t<Bits> ret{ static_cast<uint64_t>((value < 0) ? -value : value) };
+
+		if (value < 0) ret = num - ret;
+		return ctx.to_mont(ret);
+	};
+	d_mont = residue(d_param);
+	q_mont = residue(q_param);
+
+	/*
+	x / 2 mod num. num is odd, so an odd x becomes (x + num) / 2, which is
+	put together from the halves so it can not overflow
+	*/
+	half_num = num >> 1u;
+	auto halve = [&](const uint_t<Bits>& x){
+		if (x & 1ull) return (x >> 1u) + half_num + 1ull;
+		return x >> 1u;
+	};
+
+	// V_2k = V_k^2 - 2Q^k and Q^2k, for the ladder and the tail
+	auto double_v = [&](){
+		v = ctx.mont_sqr(v);
+		sub_mod(v, q_k, num, &v);
+		sub_mod(v, q_k, num, &v);
+		q_k = ctx.mont_sqr(q_k);
+	};
+
+	// num + 1 = d * 2^s, without forming num + 1 which may not fit
+	d = half_num + 1ull;
+	s = d.trailing_zeros();
+	d >>= s;
+	++s;
+
+	// U_1 = 1, V_1 = P = 1, Q^1 = Q
+	u = ctx.one();
+	v = ctx.one();
+	q_k = q_mont;
+	for (auto i = static_cast<int>(d.num_bits()) - 2; i >= 0; --i){
+		u = ctx.mont_mul(u, v);
+		double_v();
+
+		if (d.test_bit(static_cast<uint16_t>(i))){
+			uint_t<Bits> sum, d_u;
+
+			add_mod(u, v, num, &sum);
+			d_u = ctx.mont_mul(d_mont, u);
+			add_mod(d_u, v, num, &v);
+			u = halve(sum);
+			v = halve(v);
+			q_k = ctx.mont_mul(q_k, q_mont);
+		}
+	}
+
+	if (u == 0ull || v == 0ull) return true;
+	for (auto r = 1u; r < s; ++r){
+		double_v();
+		if (v == 0ull) return true;
+	}
+	return false;
+}
+
+/*
+miller_rabin_test
+
+true if num has no factor up to 229 and is a strong probable prime to
+'accuracy' random bases drawn from gen.
+rejects 2, 3 and the small primes themselves
+*/
+template <uint16_t Bits, typename URBG>
+bool miller_rabin_test(const uint_t<Bits>& num, const unsigned accuracy, URBG* gen){
+	BIGNUM_INSTRUMENT_MR(test, 0u);
+
+	// make sure num is odd and greater than 3
+	if (!(num & 1ull) || (num <= 3ull)){
+		BIGNUM_INSTRUMENT_MR(trivial, 0u);
+		return false;
+	}
+
+	if (small_prime_factor(num)){
+		BIGNUM_INSTRUMENT_MR(trial_division, 0u);
+		return false;
+	}
+
+	// every multiplication is mod num, so do them in montgomery form
+	MontgomeryContext<Bits> ctx{ num };
 
-	auto k = 1u;
 	for (auto k = 0u; k < accuracy; ++k){
-		a = uint2048::Random(2ull, num - 2ull, mt_rand);
-		x = 1ull;
+		if (!strong_probable_prime(num, uint_t<Bits>::Random(2ull, num - 2ull, gen), ctx)){
+			BIGNUM_INSTRUMENT_MR(round, k);
+			return false;
+		}
+	}
+
+	BIGNUM_INSTRUMENT_MR(passed, 0u);
+	return true;
+}
 
-		// right to left binary method for modular exponentiation
+/*
+bpsw_test
 
-		auto base = a;
-		auto exp = d;
+baillie-psw: trial division by the primes up to 229, a strong probable
+prime test to base 2 and a strong lucas test with selfridge's parameters.
+no composite is known to pass both, and none exists below 2^64.
+costs about three modular exponentiations, one for the base 2 test and
+about two for the lucas sequences, against one per miller rabin round.
+deterministic, and unlike miller_rabin_test it accepts 2, 3 and the
+small primes.
+counts in the instrumentation of miller_rabin_test, with the base 2 test
+as round 0 and the lucas test as round 1
+*/
+template <uint16_t Bits>
+bool bpsw_test(const uint_t<Bits>& num){
+	uint64_t factor;
 
-		while (exp > 0ull){
-			if (exp & 1ull) x = (x * base) % num;
-			exp >>= 1u;
-			base = (base * base) % num;
+	BIGNUM_INSTRUMENT_MR(test, 0u);
+
+	if (num < 4ull || !(num & 1ull)){
+		if (num == 2ull || num == 3ull){
+			BIGNUM_INSTRUMENT_MR(passed, 0u);
+			return true;
 		}
+		BIGNUM_INSTRUMENT_MR(trivial, 0u);
+		return false;
+	}
 
-		if (x == 1ull || x == (num - 1ull)) continue;
-		
-		for (auto i = 0u; i < (s - 1u); ++i){
-			x = (x * x) % num;
-			if (x == 1ull) return false;
-			if (x == (num - 1ull)) goto loop_end;
+	factor = small_prime_factor(num);
+	if (factor){
+		if (num == factor){
+			BIGNUM_INSTRUMENT_MR(passed, 0u);
+			return true;
 		}
+		BIGNUM_INSTRUMENT_MR(trial_division, 0u);
+		return false;
+	}
+
+	// no factor up to 229, so everything below 229^2 is prime
+	if (num < 52441ull){
+		BIGNUM_INSTRUMENT_MR(passed, 0u);
+		return true;
+	}
+
+	MontgomeryContext<Bits> ctx{ num };
+
+	if (!strong_probable_prime(num, uint_t<Bits>{ 2ull }, ctx)){
+		BIGNUM_INSTRUMENT_MR(round, 0u);
+		return false;
+	}
+	if (!strong_lucas_probable_prime(num, ctx)){
+		BIGNUM_INSTRUMENT_MR(round, 1u);
 		return false;
-	loop_end:;
 	}
 
+	BIGNUM_INSTRUMENT_MR(passed, 0u);
 	return true;
 }
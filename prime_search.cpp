@@ -0,0 +1,131 @@
+#include "prime_search.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "prime_sieve.hpp"
+#include "primality_tests.hpp"
+#include "random.hpp"
+
+/*
+runs one attempt of find_prime from 'start', gen draws the miller rabin
+bases. returns false without finishing once an earlier attempt has found
+a prime
+*/
+template <uint16_t Bits>
+static bool search_attempt(uint16_t bits, unsigned rounds, const uint_t<Bits>& start, uint64_t attempt,
+	const std::atomic<uint64_t>& found_attempt, Xoshiro256* gen, uint_t<Bits>* prime){
+	uint_t<Bits> candidate;
+
+	// ~12% of odd numbers survive the sieve, so a window of 1024 odd
+	// numbers holds well over PRIME_SEARCH_CANDIDATES of them
+	PrimeSieve<Bits> sieve{ start, 2048u, 1024u };
+
+	for (auto i = 0u; i < PRIME_SEARCH_CANDIDATES; ++i){
+		if (attempt > found_attempt.load(std::memory_order_relaxed)) return false;
+
+		// ran past the top of the bit length
+		candidate = sieve.next();
+		if (candidate.num_bits() != bits) return false;
+
+		if (bpsw_test(candidate) && (!rounds || miller_rabin_test(candidate, rounds, gen))){
+			*prime = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+the search both versions of find_prime share.
+begin_attempt(attempt, &start, &gen) sets the random start of an attempt
+and the generator for its miller rabin bases, it is called from the
+worker threads
+*/
+template <uint16_t Bits, typename BeginAttempt>
+static uint_t<Bits> search(uint16_t bits, unsigned rounds, unsigned threads, BeginAttempt begin_attempt){
+	if (bits < 16u || bits > Bits) throw std::invalid_argument("find_prime: bits out of range");
+
+	std::atomic<uint64_t> next_attempt{ 0ull };
+	std::atomic<uint64_t> found_attempt{ ~0ull };
+	std::mutex result_mutex;
+	std::vector<std::thread> workers;
+	uint_t<Bits> result;
+
+	if (!threads) threads = std::thread::hardware_concurrency();
+	if (!threads) threads = 1u;
+
+	auto worker = [&]{
+		uint_t<Bits> start, prime;
+		Xoshiro256 gen;
+
+		for (;;){
+			// attempts are handed out in increasing order, so once one past
+			// the winner is taken every later one would be wasted
+			auto attempt = next_attempt.fetch_add(1ull);
+			if (attempt > found_attempt.load()) return;
+
+			begin_attempt(attempt, &start, &gen);
+			if (!search_attempt(bits, rounds, start, attempt, found_attempt, &gen, &prime)) continue;
+
+			// an earlier attempt that finishes later still wins
+			std::lock_guard<std::mutex> lock{ result_mutex };
+			if (attempt < found_attempt.load()){
+				result = prime;
+				found_attempt.store(attempt);
+			}
+		}
+	};
+
+	// the calling thread works too
+	for (auto i = 1u; i < threads; ++i) workers.emplace_back(worker);
+	worker();
+	for (auto& thread : workers) thread.join();
+
+	return result;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> find_prime(uint16_t bits, unsigned rounds, unsigned threads, SecureRandom* gen){
+	std::mutex gen_mutex;
+
+	return search<Bits>(bits, rounds, threads, [&](uint64_t, uint_t<Bits>* start, Xoshiro256* bases){
+		std::lock_guard<std::mutex> lock{ gen_mutex };
+
+		// the start decides the prime, so it has to be unpredictable.
+		// the bases only have to be random, Xoshiro256 is plenty for them
+		*start = uint_t<Bits>::Random(bits, gen);
+		*bases = Xoshiro256{ (*gen)(), (*gen)() };
+	});
+}
+
+template <uint16_t Bits>
+uint_t<Bits> find_prime_seeded(uint16_t bits, unsigned rounds, unsigned threads, uint64_t seed){
+	return search<Bits>(bits, rounds, threads, [&](uint64_t attempt, uint_t<Bits>* start, Xoshiro256* bases){
+		// the same generator draws the start and then the bases, so an
+		// attempt gives the same answer whichever thread runs it
+		*bases = Xoshiro256{ seed, attempt };
+		*start = uint_t<Bits>::Random(bits, bases);
+	});
+}
+
+// --- instantiations ---
+
+template uint_t<256u> find_prime(uint16_t, unsigned, unsigned, SecureRandom*);
+template uint_t<512u> find_prime(uint16_t, unsigned, unsigned, SecureRandom*);
+template uint_t<1024u> find_prime(uint16_t, unsigned, unsigned, SecureRandom*);
+template uint_t<1536u> find_prime(uint16_t, unsigned, unsigned, SecureRandom*);
+template uint_t<2048u> find_prime(uint16_t, unsigned, unsigned, SecureRandom*);
+template uint_t<3072u> find_prime(uint16_t, unsigned, unsigned, SecureRandom*);
+template uint_t<4096u> find_prime(uint16_t, unsigned, unsigned, SecureRandom*);
+
+template uint_t<256u> find_prime_seeded(uint16_t, unsigned, unsigned, uint64_t);
+template uint_t<512u> find_prime_seeded(uint16_t, unsigned, unsigned, uint64_t);
+template uint_t<1024u> find_prime_seeded(uint16_t, unsigned, unsigned, uint64_t);
+template uint_t<1536u> find_prime_seeded(uint16_t, unsigned, unsigned, uint64_t);
+template uint_t<2048u> find_prime_seeded(uint16_t, unsigned, unsigned, uint64_t);
+template uint_t<3072u> find_prime_seeded(uint16_t, unsigned, unsigned, uint64_t);
+template uint_t<4096u> find_prime_seeded(uint16_t, unsigned, unsigned, uint64_t);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include "random.hpp"
+#include "uint2048.hpp"
+
+/*
+number of sieve survivors one attempt of find_prime tests before it gives up
+and the next attempt starts over from a new random number
+*/
+#ifndef PRIME_SEARCH_CANDIDATES
+#define PRIME_SEARCH_CANDIDATES 64u
+#endif
+
+/*
+find_prime
+
+returns a random probable prime of exactly 'bits' bits. every candidate
+has to pass bpsw_test, and then 'rounds' more rounds of miller rabin with
+random bases if rounds is not 0. bpsw alone has no known counterexample,
+the extra rounds are for callers that want the random bases on top.
+
+the search is a sequence of numbered attempts. each attempt draws a random
+start from gen and tests the first PRIME_SEARCH_CANDIDATES candidates a
+PrimeSieve gives from there, with the miller rabin bases coming from a
+Xoshiro256 seeded from gen. 'threads' workers (the number of hardware
+threads if 0) take attempts in order and share gen under a lock. once an
+attempt succeeds, the workers on later attempts stop and no new attempts
+are started.
+
+this is the one for primes that become keys.
+requires 16 <= bits <= Bits, throws std::invalid_argument otherwise.
+instantiated in prime_search.cpp for the same widths as uint_t.
+*/
+template <uint16_t Bits>
+uint_t<Bits> find_prime(uint16_t bits, unsigned rounds, unsigned threads, SecureRandom* gen);
+
+/*
+find_prime_seeded
+
+find_prime with every random number taken from Xoshiro256, for tests and
+benchmarks that need the same prime on every run. attempt i seeds its
+generator from (seed, i) and the answer is the prime from the lowest
+attempt that found one, so the result only depends on seed, never on the
+number of threads or how they were scheduled.
+anyone who knows the seed knows the prime, never use it for a key.
+*/
+template <uint16_t Bits>
+uint_t<Bits> find_prime_seeded(uint16_t bits, unsigned rounds, unsigned threads, uint64_t seed);
@@ -0,0 +1,96 @@
+#include "prime_sieve.hpp"
+
+// --- small primes ---
+
+const std::vector<uint32_t>& small_primes(){
+	static const std::vector<uint32_t> primes = []{
+		std::vector<uint32_t> ret;
+		std::vector<uint8_t> composite(1u << 16u, 0u);
+
+		for (auto i = 3u; i < (1u << 16u); i += 2u){
+			if (composite[i]) continue;
+			ret.push_back(i);
+			for (auto j = i * i; j < (1u << 16u); j += 2u * i) composite[j] = 1u;
+		}
+		return ret;
+	}();
+	return primes;
+}
+
+// --- constructors ---
+
+template <uint16_t Bits>
+PrimeSieve<Bits>::PrimeSieve(const uint_t<Bits>& start, uint32_t num_primes, uint32_t window){
+	const auto& primes = small_primes();
+
+	if (num_primes > primes.size()) num_primes = static_cast<uint32_t>(primes.size());
+	primes_.assign(primes.begin(), primes.begin() + num_primes);
+
+	base_ = start;
+	if (!(base_ & 1ull)) ++base_;
+
+	// the only big number divisions the sieve does
+	residues_.resize(num_primes);
+	for (auto i = 0u; i < num_primes; ++i)
+		residues_[i] = static_cast<uint32_t>(mod_u64(base_, primes_[i]));
+
+	composite_.resize(window);
+	sieve_window();
+}
+
+// --- functions ---
+
+template <uint16_t Bits>
+void PrimeSieve<Bits>::sieve_window(){
+	uint32_t window, p, index;
+
+	window = static_cast<uint32_t>(composite_.size());
+	for (auto& c : composite_) c = 0u;
+
+	for (auto i = 0u; i < primes_.size(); ++i){
+		p = primes_[i];
+
+		/*
+		base_ + 2 * index = 0 mod p
+		index = -base_ / 2 mod p
+		(p + 1) / 2 is the inverse of 2 mod p
+		*/
+		index = static_cast<uint32_t>((static_cast<uint64_t>(p - residues_[i]) % p) * ((p + 1u) / 2u) % p);
+
+		// don't strike out p itself
+		if (base_ <= p && base_ + 2ull * index == p) index += p;
+
+		for (; index < window; index += p) composite_[index] = 1u;
+	}
+	position_ = 0u;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> PrimeSieve<Bits>::next(){
+	uint32_t window, step;
+
+	window = static_cast<uint32_t>(composite_.size());
+	for (;;){
+		while (position_ < window){
+			auto index = position_++;
+			if (!composite_[index]) return base_ + 2ull * index;
+		}
+
+		// move to the next window, the residues only need the step added
+		step = 2u * window;
+		base_ += step;
+		for (auto i = 0u; i < primes_.size(); ++i)
+			residues_[i] = static_cast<uint32_t>((static_cast<uint64_t>(residues_[i]) + step) % primes_[i]);
+		sieve_window();
+	}
+}
+
+// --- instantiations ---
+
+template class PrimeSieve<256u>;
+template class PrimeSieve<512u>;
+template class PrimeSieve<1024u>;
+template class PrimeSieve<1536u>;
+template class PrimeSieve<2048u>;
+template class PrimeSieve<3072u>;
+template class PrimeSieve<4096u>;
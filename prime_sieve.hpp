@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "uint2048.hpp"
+
+/*
+small_primes
+
+returns the odd primes below 2^16 in increasing order (6541 of them).
+built with the sieve of eratosthenes on the first call.
+*/
+const std::vector<uint32_t>& small_primes();
+
+/*
+
+PrimeSieve
+
+hands out prime candidates starting at a given number.
+the residues of the start modulo the first 'num_primes' odd primes are
+computed once. after that a window of odd offsets is sieved by striking out
+every multiple of those primes, and only the survivors are returned.
+moving to the next window only adds the window length to each residue,
+there is no further big number division.
+
+the candidates still need a probabilistic test, the sieve only removes the
+ones with a small factor. start should be larger than the largest sieving
+prime, or small primes would be struck out as multiples of themselves.
+
+instantiated in prime_sieve.cpp for the same widths as uint_t.
+
+*/
+template <uint16_t Bits>
+class PrimeSieve{
+private:
+	uint_t<Bits> base_;                // the number at offset 0 of the window, always odd
+	std::vector<uint32_t> primes_;     // sieving primes
+	std::vector<uint32_t> residues_;   // base_ mod primes_[i]
+	std::vector<uint8_t> composite_;   // composite_[i] is set if base_ + 2i has a small factor
+	uint32_t position_;                // next offset to look at in the window
+
+	/*
+	strikes out the multiples of every sieving prime in the current window
+	*/
+	void sieve_window();
+
+public:
+
+	// --- constructors ---
+
+	/*
+	prepares to hand out candidates >= start.
+	'window' is the number of odd offsets sieved at a time
+	*/
+	PrimeSieve(const uint_t<Bits>& start, uint32_t num_primes = 2048u, uint32_t window = 4096u);
+
+	// --- functions ---
+
+	/*
+	returns the next number that has no factor among the sieving primes
+	*/
+	uint_t<Bits> next();
+
+};
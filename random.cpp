@@ -0,0 +1,50 @@
+#include "random.hpp"
+
+#include <cerrno>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <bcrypt.h>
+#elif defined(__linux__)
+#include <sys/random.h>
+#else
+#include <unistd.h>
+#endif
+
+// --- constructors ---
+
+SecureRandom::~SecureRandom(){
+	// the numbers not handed out yet, volatile so the stores are not dropped
+	volatile uint64_t* pool = pool_;
+
+	for (auto i = used_; i < 32u; ++i) pool[i] = 0ull;
+}
+
+// --- functions ---
+
+void SecureRandom::refill(){
+#if defined(_WIN32)
+	if (BCryptGenRandom(nullptr, reinterpret_cast<PUCHAR>(pool_), sizeof(pool_), BCRYPT_USE_SYSTEM_PREFERRED_RNG) != 0)
+		throw std::runtime_error("SecureRandom: BCryptGenRandom failed");
+#elif defined(__linux__)
+	auto bytes = reinterpret_cast<unsigned char*>(pool_);
+	size_t filled = 0u;
+
+	// reads of up to 256 bytes are not cut short once the pool is seeded,
+	// but a signal can still interrupt the first one at boot
+	while (filled < sizeof(pool_)){
+		auto got = getrandom(bytes + filled, sizeof(pool_) - filled, 0u);
+		if (got < 0){
+			if (errno == EINTR) continue;
+			throw std::runtime_error("SecureRandom: getrandom failed");
+		}
+		filled += static_cast<size_t>(got);
+	}
+#else
+	// getentropy takes at most 256 bytes, exactly the size of the pool
+	if (getentropy(pool_, sizeof(pool_)) != 0) throw std::runtime_error("SecureRandom: getentropy failed");
+#endif
+	used_ = 0u;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+
+Xoshiro256
+
+xoshiro256** (blackman and vigna), a small and fast 64 bit generator with
+256 bits of state. a few shifts, rotates and one multiply per number
+against the 2.5kB state of std::mt19937_64 that has to be refilled every
+312 numbers, and seeding it is four calls to splitmix64 instead of a
+std::seed_seq.
+
+meets UniformRandomBitGenerator, so it can be passed to uint_t::Random,
+fill_random and miller_rabin_test like any standard engine.
+not for keys that have to stay secret, it is not a cryptographic generator,
+use SecureRandom for those.
+
+*/
+class Xoshiro256{
+private:
+	uint64_t state_[4];
+
+	static uint64_t rotl(uint64_t x, unsigned k){
+		return (x << k) | (x >> (64u - k));
+	}
+
+	/*
+	splitmix64, spreads a 64 bit seed over the state.
+	every step adds a constant, so the state never ends up all zero
+	*/
+	static uint64_t splitmix64(uint64_t* x){
+		uint64_t z;
+
+		*x += 0x9e3779b97f4a7c15ull;
+		z = *x;
+		z = (z ^ (z >> 30u)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27u)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31u);
+	}
+
+public:
+	using result_type = uint64_t;
+
+	// --- constructors ---
+
+	/*
+	seeds the state from 'seed' and 'stream' with splitmix64.
+	generators with the same seed and different streams give unrelated
+	sequences, one stream per thread or per task
+	*/
+	explicit Xoshiro256(uint64_t seed = 0ull, uint64_t stream = 0ull){
+		uint64_t x, y;
+
+		x = seed;
+		y = splitmix64(&stream);
+		for (auto i = 0u; i < 4u; ++i) state_[i] = splitmix64(&x) ^ splitmix64(&y);
+	}
+
+	// --- functions ---
+
+	static constexpr result_type min(){ return 0ull; }
+	static constexpr result_type max(){ return ~0ull; }
+
+	result_type operator()(){
+		uint64_t result, t;
+
+		result = rotl(state_[1] * 5ull, 7u) * 9ull;
+		t = state_[1] << 17u;
+
+		state_[2] ^= state_[0];
+		state_[3] ^= state_[1];
+		state_[1] ^= state_[2];
+		state_[0] ^= state_[3];
+		state_[2] ^= t;
+		state_[3] = rotl(state_[3], 45u);
+		return result;
+	}
+
+};
+
+/*
+
+SecureRandom
+
+the operating system's cryptographic generator (BCryptGenRandom on windows,
+getrandom on linux, getentropy elsewhere), for anything that ends up in a
+secret key. numbers are fetched 32 at a time, and every one is wiped from
+the buffer once it has been handed out.
+
+meets UniformRandomBitGenerator like Xoshiro256, but costs a system call
+every 32 numbers, so leave the bulk work to Xoshiro256 and use this for
+the parts that have to be unpredictable.
+not thread safe, and not copyable so two copies never hand out the same
+numbers. throws std::runtime_error if the system generator fails.
+
+*/
+class SecureRandom{
+private:
+	uint64_t pool_[32];
+	unsigned used_;
+
+	void refill();
+
+public:
+	using result_type = uint64_t;
+
+	// --- constructors ---
+
+	SecureRandom() : used_{ 32u }{}
+	SecureRandom(const SecureRandom&) = delete;
+	SecureRandom& operator=(const SecureRandom&) = delete;
+	~SecureRandom();
+
+	// --- functions ---
+
+	static constexpr result_type min(){ return 0ull; }
+	static constexpr result_type max(){ return ~0ull; }
+
+	result_type operator()(){
+		uint64_t result;
+
+		if (used_ == 32u) refill();
+		result = pool_[used_];
+		pool_[used_++] = 0ull;
+		return result;
+	}
+
+};
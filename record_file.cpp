@@ -0,0 +1,201 @@
+#include "record_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+the header in front of the records
+*/
+struct RecordFileHeader{
+	char magic[8];         // RECORD_FILE_MAGIC
+	uint32_t bits;         // Bits of the uint_t the records are
+	uint32_t record_size;  // sizeof(uint_t<Bits>) on the machine that wrote them
+	uint64_t count;        // number of records
+};
+
+#define RECORD_FILE_MAGIC "UINTREC1"
+
+// the records that follow the header have to stay aligned
+static_assert(sizeof(RecordFileHeader) % alignof(uint64_t) == 0u, "RecordFile: header breaks record alignment");
+
+// --- constructors ---
+
+template <uint16_t Bits>
+RecordFile<Bits>::RecordFile(const std::string& path, bool check_records){
+	RecordFileHeader header;
+
+	data_ = nullptr;
+	length_ = 0u;
+	count_ = 0u;
+
+#if defined(_WIN32)
+	LARGE_INTEGER size;
+
+	mapping_ = nullptr;
+	file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size)){
+		unmap();
+		throw std::runtime_error("RecordFile: can not open " + path);
+	}
+	length_ = static_cast<size_t>(size.QuadPart);
+
+	if (length_ >= sizeof(header)){
+		mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping_) data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+		if (!data_){
+			unmap();
+			throw std::runtime_error("RecordFile: can not map " + path);
+		}
+	}
+#else
+	struct stat info;
+	int fd;
+
+	fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("RecordFile: can not open " + path);
+	if (fstat(fd, &info) != 0){
+		close(fd);
+		throw std::runtime_error("RecordFile: can not open " + path);
+	}
+	length_ = static_cast<size_t>(info.st_size);
+
+	if (length_ >= sizeof(header)){
+		auto mapped = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (mapped == MAP_FAILED){
+			close(fd);
+			throw std::runtime_error("RecordFile: can not map " + path);
+		}
+		data_ = static_cast<const uint8_t*>(mapped);
+	}
+	// the mapping stays valid without the descriptor
+	close(fd);
+#endif
+
+	if (length_ < sizeof(header)){
+		unmap();
+		throw std::invalid_argument("RecordFile: " + path + " is not a record file");
+	}
+
+	std::memcpy(&header, data_, sizeof(header));
+	if (std::memcmp(header.magic, RECORD_FILE_MAGIC, sizeof(header.magic)) != 0
+		|| header.bits != Bits || header.record_size != sizeof(uint_t<Bits>)
+		|| header.count > (length_ - sizeof(header)) / sizeof(uint_t<Bits>)){
+		unmap();
+		throw std::invalid_argument("RecordFile: " + path + " is not a record file for this width");
+	}
+	count_ = static_cast<size_t>(header.count);
+	if (!check_records) return;
+
+	/*
+	every operator trusts size_, so a record with a size_ that does not
+	match its limbs would give wrong answers later on. one pass over the
+	file up front instead of a check on every access
+	*/
+	for (auto num = begin(); num != end(); ++num){
+		auto size = num->size_;
+
+		if (size > uint_t<Bits>::Limbs || (size && !num->parts_[size - 1u])){
+			unmap();
+			throw std::invalid_argument("RecordFile: " + path + " has an invalid record");
+		}
+		for (auto i = size; i < uint_t<Bits>::Limbs; ++i){
+			if (num->parts_[i]){
+				unmap();
+				throw std::invalid_argument("RecordFile: " + path + " has an invalid record");
+			}
+		}
+	}
+}
+
+// --- destructor ---
+
+template <uint16_t Bits>
+RecordFile<Bits>::~RecordFile(){
+	unmap();
+}
+
+// --- functions ---
+
+template <uint16_t Bits>
+void RecordFile<Bits>::unmap(){
+#if defined(_WIN32)
+	if (data_) UnmapViewOfFile(data_);
+	if (mapping_) CloseHandle(mapping_);
+	if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+	mapping_ = nullptr;
+	file_ = INVALID_HANDLE_VALUE;
+#else
+	if (data_) munmap(const_cast<uint8_t*>(data_), length_);
+#endif
+	data_ = nullptr;
+	length_ = 0u;
+	count_ = 0u;
+}
+
+template <uint16_t Bits>
+const uint_t<Bits>* RecordFile<Bits>::begin() const{
+	// the mapping is page aligned and the header keeps the records aligned
+	return reinterpret_cast<const uint_t<Bits>*>(data_ + sizeof(RecordFileHeader));
+}
+
+// --- static functions ---
+
+template <uint16_t Bits>
+void RecordFile<Bits>::write(const std::string& path, const uint_t<Bits>* nums, size_t count){
+	RecordFileHeader header;
+	std::vector<uint_t<Bits>> buffer;
+	std::FILE* file;
+	bool ok;
+
+	std::memcpy(header.magic, RECORD_FILE_MAGIC, sizeof(header.magic));
+	header.bits = Bits;
+	header.record_size = sizeof(uint_t<Bits>);
+	header.count = count;
+
+	file = std::fopen(path.c_str(), "wb");
+	if (!file) throw std::runtime_error("RecordFile: can not open " + path);
+	ok = std::fwrite(&header, sizeof(header), 1u, file) == 1u;
+
+	/*
+	the records go through a buffer that was zeroed first, so the padding
+	behind size_ is written as zeros and the same numbers always give the
+	same file
+	*/
+	buffer.resize((count < 256u) ? count : 256u);
+	for (size_t done = 0u; ok && done < count; done += buffer.size()){
+		auto batch = (count - done < buffer.size()) ? count - done : buffer.size();
+
+		std::memset(static_cast<void*>(buffer.data()), 0, batch * sizeof(uint_t<Bits>));
+		for (size_t i = 0u; i < batch; ++i){
+			std::memcpy(buffer[i].parts_, nums[done + i].parts_, sizeof(buffer[i].parts_));
+			buffer[i].size_ = nums[done + i].size_;
+		}
+		ok = std::fwrite(buffer.data(), sizeof(uint_t<Bits>), batch, file) == batch;
+	}
+
+	if (std::fclose(file) != 0) ok = false;
+	if (!ok) throw std::runtime_error("RecordFile: can not write " + path);
+}
+
+// --- instantiations ---
+
+template class RecordFile<256u>;
+template class RecordFile<512u>;
+template class RecordFile<1024u>;
+template class RecordFile<1536u>;
+template class RecordFile<2048u>;
+template class RecordFile<3072u>;
+template class RecordFile<4096u>;
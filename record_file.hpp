@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "uint2048.hpp"
+
+/*
+
+RecordFile
+
+a read only view of a file of uint_t<Bits> records, mapped into memory.
+the records are stored exactly as uint_t<Bits> is laid out in memory, one
+after another behind a small header, so the view hands out references
+straight into the mapping and nothing is copied or converted. uint_t is
+trivially copyable, which is what makes this work.
+
+opening a file checks every record once, which reads the whole file, so
+it costs O(file size). files this program wrote itself can skip the check,
+then only the header is read and the records are paged in as they are used.
+
+the layout is that of the machine that wrote the file. the header holds
+Bits and the record size, and a file written for another width or layout
+is rejected when it is opened. write the files with RecordFile::write,
+use uint_t::to_bytes and uint_t::from_bytes for portable formats.
+
+instantiated in record_file.cpp for the same widths as uint_t.
+
+*/
+template <uint16_t Bits>
+class RecordFile{
+private:
+	const uint8_t* data_;  // the whole mapping, header first
+	size_t length_;        // bytes mapped
+	size_t count_;         // number of records
+
+#if defined(_WIN32)
+	void* file_;
+	void* mapping_;
+#endif
+
+	void unmap();
+
+public:
+
+	// --- constructors ---
+
+	/*
+	maps the file at 'path' and, if check_records is set, reads every record
+	once to check it is a valid uint_t. every operator trusts the size of a
+	uint_t, so only clear check_records for files that come from
+	RecordFile::write of a trusted source.
+	throws std::runtime_error if the file can not be opened or mapped and
+	std::invalid_argument if it is not a record file for this width, or a
+	checked record is not a valid uint_t
+	*/
+	explicit RecordFile(const std::string& path, bool check_records = true);
+
+	RecordFile(const RecordFile&) = delete;
+	RecordFile& operator=(const RecordFile&) = delete;
+
+	// --- destructor ---
+	~RecordFile();
+
+	// --- functions ---
+
+	/*
+	returns the number of records
+	*/
+	size_t size() const{ return count_; }
+
+	const uint_t<Bits>* begin() const;
+	const uint_t<Bits>* end() const{ return begin() + count_; }
+
+	/*
+	returns the record at 'index', no bounds check
+	*/
+	const uint_t<Bits>& operator[](size_t index) const{ return begin()[index]; }
+
+	// --- static functions ---
+
+	/*
+	writes the 'count' numbers at nums to a new record file at 'path',
+	replacing what was there.
+	throws std::runtime_error if the file can not be written
+	*/
+	static void write(const std::string& path, const uint_t<Bits>* nums, size_t count);
+
+};
@@ -0,0 +1,111 @@
+#include "rsa.hpp"
+
+#include <random>
+#include <stdexcept>
+
+#include "prime_search.hpp"
+
+// --- constructors ---
+
+template <uint16_t Bits>
+RsaKey<Bits>::RsaKey(const uint_t<HalfBits>& p, const uint_t<HalfBits>& q, uint64_t e) :
+	p_{ p },
+	q_{ q },
+	n_{ uint_t<Bits>{ p } * uint_t<Bits>{ q } },
+	e_{ e },
+	ctx_n_{ n_ },
+	ctx_p_{ p },
+	ctx_q_{ q }{
+	if (p_ == q_) throw std::invalid_argument("RsaKey: p and q must be distinct");
+
+	uint_t<Bits> p_minus_one, q_minus_one, lambda;
+	uint_t<HalfBits> qinv;
+
+	p_minus_one = uint_t<Bits>{ p_ } - 1ull;
+	q_minus_one = uint_t<Bits>{ q_ } - 1ull;
+
+	// lambda(n) = lcm(p - 1, q - 1)
+	lambda = p_minus_one / gcd_lehmer(p_minus_one, q_minus_one) * q_minus_one;
+	if (!mod_inverse(e_, lambda, &d_)) throw std::invalid_argument("RsaKey: e has no inverse mod lambda(n)");
+
+	dp_ = uint_t<HalfBits>{ d_ % p_minus_one };
+	dq_ = uint_t<HalfBits>{ d_ % q_minus_one };
+
+	// p and q are distinct primes, so the inverse is always there
+	mod_inverse(q_, p_, &qinv);
+	qinv_mont_ = ctx_p_.to_mont(qinv);
+}
+
+/*
+builds a key from the primes next_prime() returns, drawing more until
+p - 1 and q - 1 are coprime to e and n has exactly Bits bits
+*/
+template <uint16_t Bits, typename NextPrime>
+static RsaKey<Bits> generate_key(uint64_t e, NextPrime next_prime){
+	constexpr auto HalfBits = RsaKey<Bits>::HalfBits;
+	uint_t<HalfBits> p, q;
+
+	// p - 1 and q - 1 must not share a factor with e, or d would not exist
+	do p = next_prime();
+	while (gcd_lehmer(p - 1ull, uint_t<HalfBits>{ e }) != 1ull);
+
+	// two HalfBits bit primes can multiply to Bits - 1 bits, draw q again until n is full size
+	for (;;){
+		q = next_prime();
+		if (q == p || gcd_lehmer(q - 1ull, uint_t<HalfBits>{ e }) != 1ull) continue;
+		if ((uint_t<Bits>{ p } * uint_t<Bits>{ q }).num_bits() == Bits) break;
+	}
+	return RsaKey<Bits>{ p, q, e };
+}
+
+template <uint16_t Bits>
+RsaKey<Bits> RsaKey<Bits>::generate(SecureRandom* gen, unsigned rounds, unsigned threads, uint64_t e){
+	return generate_key<Bits>(e, [&]{ return find_prime<HalfBits>(HalfBits, rounds, threads, gen); });
+}
+
+template <uint16_t Bits>
+RsaKey<Bits> RsaKey<Bits>::generate_seeded(uint64_t seed, unsigned rounds, unsigned threads, uint64_t e){
+	std::mt19937_64 seeds{ seed };
+
+	return generate_key<Bits>(e, [&]{ return find_prime_seeded<HalfBits>(HalfBits, rounds, threads, seeds()); });
+}
+
+// --- functions ---
+
+template <uint16_t Bits>
+uint_t<Bits> RsaKey<Bits>::public_op(const uint_t<Bits>& message) const{
+	if (message >= n_) throw std::invalid_argument("RsaKey: message must be less than n");
+	return pow_mod(message, e_, ctx_n_);
+}
+
+template <uint16_t Bits>
+uint_t<Bits> RsaKey<Bits>::private_op(const uint_t<Bits>& message) const{
+	if (message >= n_) throw std::invalid_argument("RsaKey: message must be less than n");
+
+	uint_t<HalfBits> m_p, m_q;
+	uint_t<HalfBits> h;
+	uint_t<Bits> ret;
+
+	// message^d mod p and mod q
+	m_p = pow_mod(uint_t<HalfBits>{ message % uint_t<Bits>{ p_ } }, dp_, ctx_p_);
+	m_q = pow_mod(uint_t<HalfBits>{ message % uint_t<Bits>{ q_ } }, dq_, ctx_q_);
+
+	/*
+	garner: h = qinv * (m_p - m_q) mod p, then m = m_q + h * q.
+	m_q is below q but not always below p, sub_mod reduces it first then.
+	the montgomery multiply by qinv * R takes the R back out
+	*/
+	sub_mod(m_p, m_q, p_, &h);
+	h = ctx_p_.mont_mul(qinv_mont_, h);
+
+	mul_add(uint_t<Bits>{ h }, uint_t<Bits>{ q_ }, uint_t<Bits>{ m_q }, &ret);
+	return ret;
+}
+
+// --- instantiations ---
+
+template class RsaKey<512u>;
+template class RsaKey<1024u>;
+template class RsaKey<2048u>;
+template class RsaKey<3072u>;
+template class RsaKey<4096u>;
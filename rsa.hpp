@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+
+#include "montgomery.hpp"
+#include "random.hpp"
+#include "uint2048.hpp"
+
+/*
+
+RsaKey
+
+an RSA key pair with a modulus n of Bits bits made from two primes p and q
+of Bits / 2 bits each.
+
+d is the inverse of e modulo lambda(n) = lcm(p - 1, q - 1). private_op
+does not use d directly though, it works mod p and mod q with
+dp = d mod (p - 1), dq = d mod (q - 1) and qinv = q^-1 mod p and joins
+the two halves with the chinese remainder theorem (garner's formula).
+two exponentiations of half the size with half the exponent bits are about
+four times less work than one mod n.
+
+montgomery contexts for n, p and q are built once with the key.
+instantiated in rsa.cpp for Bits = 512, 1024, 2048, 3072 and 4096.
+
+*/
+template <uint16_t Bits>
+class RsaKey{
+public:
+	static constexpr uint16_t HalfBits = Bits / 2u;
+
+private:
+	uint_t<HalfBits> p_;
+	uint_t<HalfBits> q_;
+	uint_t<Bits> n_;
+	uint_t<Bits> e_;
+	uint_t<Bits> d_;
+
+	uint_t<HalfBits> dp_;        // d mod (p - 1)
+	uint_t<HalfBits> dq_;        // d mod (q - 1)
+	uint_t<HalfBits> qinv_mont_; // q^-1 mod p, in montgomery form mod p
+
+	MontgomeryContext<Bits> ctx_n_;
+	MontgomeryContext<HalfBits> ctx_p_;
+	MontgomeryContext<HalfBits> ctx_q_;
+
+public:
+
+	// --- constructors ---
+
+	/*
+	builds the key from two known primes.
+	throws std::invalid_argument if p and q are equal or either is even,
+	or if e has no inverse mod lambda(n)
+	*/
+	RsaKey(const uint_t<HalfBits>& p, const uint_t<HalfBits>& q, uint64_t e = 65537ull);
+
+	/*
+	generates a new key with find_prime, the primes come from gen and
+	'rounds' is passed on. p - 1 and q - 1 are coprime to e and n has
+	exactly Bits bits
+	*/
+	static RsaKey generate(SecureRandom* gen, unsigned rounds = 0u, unsigned threads = 0u, uint64_t e = 65537ull);
+
+	/*
+	generate with the primes from find_prime_seeded, the same seed always
+	gives the same key. for tests and benchmarks only, the seed is the key
+	*/
+	static RsaKey generate_seeded(uint64_t seed, unsigned rounds = 0u, unsigned threads = 0u, uint64_t e = 65537ull);
+
+	// --- functions ---
+
+	const uint_t<HalfBits>& p() const{ return p_; }
+	const uint_t<HalfBits>& q() const{ return q_; }
+	const uint_t<Bits>& n() const{ return n_; }
+	const uint_t<Bits>& e() const{ return e_; }
+	const uint_t<Bits>& d() const{ return d_; }
+
+	/*
+	returns message^e mod n.
+	throws std::invalid_argument if message >= n
+	*/
+	uint_t<Bits> public_op(const uint_t<Bits>& message) const;
+
+	/*
+	returns message^d mod n, computed with the CRT values.
+	throws std::invalid_argument if message >= n
+	*/
+	uint_t<Bits> private_op(const uint_t<Bits>& message) const;
+
+};
@@ -1,99 +1,514 @@
-
 #include "uint2048.hpp"
 
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "barrett.hpp"
+#include "instrument.hpp"
+#include "limb_ops.hpp"
+#include "montgomery.hpp"
+
+// --- U64Divisor ---
+
+U64Divisor::U64Divisor(uint64_t divisor){
+	unsigned long index;
+
+	if (!divisor) throw std::domain_error("uint_t: division by zero");
+
+	// intrinsic function
+	// bsr instruction
+	// index = position of the most significant set bit
+	_BitScanReverse64(&index, divisor);
+
+	divisor_ = divisor;
+	shift_ = static_cast<uint8_t>(63u - index);
+	normalized_ = divisor << shift_;
+	reciprocal_ = limbs_reciprocal_1(normalized_);
+}
+
 // --- constructors ---
 
 // - standard -
 
-uint2048::uint2048(){
-	for (auto i = 0u; i < 32u; ++i) parts_[i] = 0ull;
+template <uint16_t Bits>
+uint_t<Bits>::uint_t(){
+	limbs_zero(parts_, Limbs);
+	size_ = 0u;
 }
 
-uint2048::uint2048(uint64_t num){
-	for (auto i = 1u; i < 32u; ++i) parts_[i] = 0ull;
+template <uint16_t Bits>
+uint_t<Bits>::uint_t(uint64_t num){
+	for (auto i = 1u; i < Limbs; ++i) parts_[i] = 0ull;
 	parts_[0] = num;
+	size_ = (num != 0ull);
 }
 
-// - copy -
+// --- functions ---
 
-uint2048::uint2048(const uint2048& num){
-	for (auto i = 0u; i < 32u; ++i) parts_[i] = num.parts_[i];
+template <uint16_t Bits>
+void uint_t<Bits>::trim(uint16_t size){
+	// every limb at or above 'size' is already zero,
+	// walk down to the most significant non-zero limb
+	while (size && !parts_[size - 1u]) --size;
+	size_ = size;
 }
 
-// --- functions ---
+template <uint16_t Bits>
+void uint_t<Bits>::set_limbs(const uint64_t* limbs, uint16_t size){
+	if (size_ > size) limbs_zero(parts_ + size, size_ - size);
+	limbs_copy(parts_, limbs, size);
+	trim(size);
+}
 
-bool uint2048::highest_bit(uint16_t* index) const{
+template <uint16_t Bits>
+bool uint_t<Bits>::highest_bit(uint16_t* index) const{
 	auto res = 0ul;
-	auto part = 0ull;
-	
+
 	/*
-	loop down from the most significant ull and find the first one that is non-zero.
+	the most significant non-zero ull is at size_ - 1.
 	use the intrinsic function _BitScanReverse64 to find the index of that ull's
 	most significant bit.
 	set the index pointer's value to:
 		64 * num of ulls below + the index resulting from _BitScanReverse64
 	return true
 
-	if all ulls are found to be zero, set the index to 0 and return false.
+	if all ulls are zero, set the index to 0 and return false.
 	*/
-	for (auto i = 0u; i < 32u; ++i){
-		part = parts_[31u - i];
-		if (part > 0u){
-			// intrinsic function
-			// bsr instruction
-			// find index of most significant bit
-			_BitScanReverse64(&res, part);
-			
-			// could use FMA here?
-			*index = ((31u - i) * 64u) + static_cast<uint16_t>(res);
-			return true;
-		}
+	if (!size_){
+		*index = 0u;
+		return false;
 	}
-	*index = 0u;
-	return false;
+
+	// intrinsic function
+	// bsr instruction
+	// find index of most significant bit
+	_BitScanReverse64(&res, parts_[size_ - 1u]);
+
+	*index = ((size_ - 1u) * 64u) + static_cast<uint16_t>(res);
+	return true;
 }
 
-uint16_t uint2048::num_bits() const{
+template <uint16_t Bits>
+uint16_t uint_t<Bits>::num_bits() const{
 	uint16_t res = 0u;
 
 	if (highest_bit(&res)) return ++res;
 	else return res;
 }
 
+template <uint16_t Bits>
+bool uint_t<Bits>::test_bit(uint16_t index) const{
+	if (index >= Bits) return false;
+	return (parts_[index / 64u] >> (index % 64u)) & 1ull;
+}
+
+template <uint16_t Bits>
+uint64_t uint_t<Bits>::bits_at(uint16_t index) const{
+	uint16_t limb, bit;
+	uint64_t ret;
+
+	limb = index / 64u;
+	bit = index % 64u;
+	if (limb >= size_) return 0ull;
+
+	ret = parts_[limb] >> bit;
+	if (bit && limb + 1u < size_) ret |= parts_[limb + 1u] << (64u - bit);
+	return ret;
+}
+
+template <uint16_t Bits>
+uint16_t uint_t<Bits>::trailing_zeros() const{
+	auto res = 0ul;
+
+	for (auto i = 0u; i < size_; ++i){
+		if (!parts_[i]) continue;
+
+		// intrinsic function
+		// bsf instruction
+		// find index of least significant bit
+		_BitScanForward64(&res, parts_[i]);
+		return static_cast<uint16_t>(i * 64u + res);
+	}
+	return Bits;
+}
+
 /*
 returns a bitset representation of the parts array
 */
-std::bitset<2048> uint2048::to_bitset(){
-	return *reinterpret_cast<std::bitset<2048>*>(parts_);
+template <uint16_t Bits>
+std::bitset<Bits> uint_t<Bits>::to_bitset() const{
+	std::bitset<Bits> ret;
+
+	// bitset keeps its bits in an array of words, least significant first
+	static_assert(sizeof(ret) == sizeof(parts_), "uint_t: unexpected std::bitset layout");
+	std::memcpy(&ret, parts_, sizeof(parts_));
+	return ret;
+}
+
+// - bytes -
+
+/*
+limb 'index' of a number stored in the 'length' bytes at bytes.
+a whole limb is one load, byte swapped for big endian. the top limb of a
+length that is not a multiple of 8 is put together a byte at a time
+*/
+static uint64_t load_limb(const uint8_t* bytes, size_t length, size_t index, ByteOrder order){
+	uint64_t limb = 0ull;
+	size_t start, end;
+
+	if (order == ByteOrder::little){
+		start = 8u * index;
+		end = (start + 8u < length) ? start + 8u : length;
+		if (end - start == 8u) std::memcpy(&limb, bytes + start, 8u);
+		else for (auto i = end; i-- > start;) limb = (limb << 8u) | bytes[i];
+		return limb;
+	}
+
+	end = length - 8u * index;
+	start = (end > 8u) ? end - 8u : 0u;
+	if (end - start == 8u){
+		std::memcpy(&limb, bytes + start, 8u);
+		// intrinsic function
+		// bswap / movbe instruction
+		return _byteswap_uint64(limb);
+	}
+	for (auto i = start; i < end; ++i) limb = (limb << 8u) | bytes[i];
+	return limb;
+}
+
+/*
+the opposite of load_limb, stores limb 'index' into the 'length' bytes at out
+*/
+static void store_limb(uint8_t* out, size_t length, size_t index, uint64_t limb, ByteOrder order){
+	size_t start, end;
+
+	if (order == ByteOrder::little){
+		start = 8u * index;
+		end = (start + 8u < length) ? start + 8u : length;
+		if (end - start == 8u) std::memcpy(out + start, &limb, 8u);
+		else for (auto i = start; i < end; ++i, limb >>= 8u) out[i] = static_cast<uint8_t>(limb);
+		return;
+	}
+
+	end = length - 8u * index;
+	start = (end > 8u) ? end - 8u : 0u;
+	if (end - start == 8u){
+		// intrinsic function
+		// bswap / movbe instruction
+		limb = _byteswap_uint64(limb);
+		std::memcpy(out + start, &limb, 8u);
+		return;
+	}
+	for (auto i = end; i-- > start; limb >>= 8u) out[i] = static_cast<uint8_t>(limb);
+}
+
+template <uint16_t Bits>
+bool uint_t<Bits>::to_bytes(uint8_t* out, size_t length, ByteOrder order) const{
+	size_t num_limbs;
+
+	if (num_bits() > 8u * length) return false;
+
+	num_limbs = (length + 7u) / 8u;
+	for (size_t i = 0u; i < num_limbs; ++i)
+		store_limb(out, length, i, (i < size_) ? parts_[i] : 0ull, order);
+	return true;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> uint_t<Bits>::from_bytes(const uint8_t* bytes, size_t length, ByteOrder order){
+	uint_t ret;
+	size_t num_limbs;
+
+	num_limbs = (length + 7u) / 8u;
+	for (size_t i = 0u; i < num_limbs; ++i){
+		auto limb = load_limb(bytes, length, i, order);
+
+		if (i < Limbs) ret.parts_[i] = limb;
+		else if (limb) throw std::out_of_range("uint_t: number does not fit");
+	}
+	ret.trim((num_limbs < Limbs) ? static_cast<uint16_t>(num_limbs) : Limbs);
+	return ret;
+}
+
+// - strings -
+
+/*
+decimal numbers are converted 19 digits at a time, the most that fit in a
+limb. numbers of more than DECIMAL_DC_THRESHOLD limbs are split in two
+around a power 10^(19 * 2^k) and both halves converted on their own
+(divide and conquer), smaller ones one chunk of 19 digits at a time
+*/
+#ifndef DECIMAL_DC_THRESHOLD
+#define DECIMAL_DC_THRESHOLD 16u
+#endif
+
+#define DECIMAL_CHUNK_DIGITS 19u
+#define DECIMAL_CHUNK 10000000000000000000ull
+
+// number of powers 10^(19 * 2^k) kept, the largest has 8079 bits
+#define DECIMAL_POWERS 8u
+
+/*
+returns 10^(19 * 2^k) for k = 0 .. DECIMAL_POWERS - 1 as trimmed limb
+vectors. built by squaring on the first call, shared by all widths
+*/
+static const std::vector<std::vector<uint64_t>>& decimal_powers(){
+	static const std::vector<std::vector<uint64_t>> powers = []{
+		std::vector<std::vector<uint64_t>> ret;
+
+		ret.push_back({ DECIMAL_CHUNK });
+		for (auto k = 1u; k < DECIMAL_POWERS; ++k){
+			const auto& last = ret.back();
+			auto size = static_cast<uint16_t>(last.size());
+			std::vector<uint64_t> square(2u * size);
+
+			limbs_mul(square.data(), last.data(), size, last.data(), size);
+			while (!square.back()) square.pop_back();
+			ret.push_back(std::move(square));
+		}
+		return ret;
+	}();
+	return powers;
+}
+
+static void trim_limbs(std::vector<uint64_t>* limbs){
+	while (!limbs->empty() && !limbs->back()) limbs->pop_back();
+}
+
+/*
+writes a as exactly 'width' decimal digits ending at out + width.
+a must be less than 10^width, the digits above it are left as they are,
+so out has to be filled with '0' up front
+*/
+static void decimal_digits(std::vector<uint64_t> a, char* out, size_t width){
+	static const U64Divisor chunk{ DECIMAL_CHUNK };
+	const auto& powers = decimal_powers();
+	char* end;
+
+	trim_limbs(&a);
+	auto size = static_cast<uint16_t>(a.size());
+
+	if (size > DECIMAL_DC_THRESHOLD){
+		// the biggest power with no more than half the limbs of a
+		auto k = static_cast<unsigned>(powers.size());
+		while (k && (2u * powers[k - 1u].size() > size + 1u || (DECIMAL_CHUNK_DIGITS << (k - 1u)) >= width)) --k;
+
+		if (k){
+			const auto& power = powers[k - 1u];
+			auto size_p = static_cast<uint16_t>(power.size());
+			size_t low_width = DECIMAL_CHUNK_DIGITS << (k - 1u);
+			std::vector<uint64_t> q(size - size_p + 1u), r(size_p);
+
+			// a = q * 10^low_width + r, the digits of r are the low ones
+			limbs_divmod(q.data(), r.data(), a.data(), size, power.data(), size_p);
+			decimal_digits(std::move(r), out + width - low_width, low_width);
+			decimal_digits(std::move(q), out, width - low_width);
+			return;
+		}
+	}
+
+	// peel off 19 digits at a time from the bottom
+	end = out + width;
+	while (size){
+		auto rem = limbs_divmod_1_preinv(a.data(), a.data(), size, chunk.normalized(), chunk.shift(), chunk.reciprocal());
+
+		while (size && !a[size - 1u]) --size;
+		for (auto i = 0u; i < DECIMAL_CHUNK_DIGITS && end > out; ++i){
+			*--end = static_cast<char>('0' + rem % 10u);
+			rem /= 10u;
+		}
+	}
+}
+
+/*
+returns the value of the 'length' decimal digits at str as trimmed limbs.
+the digits must have been checked already
+*/
+static std::vector<uint64_t> decimal_value(const char* str, size_t length){
+	const auto& powers = decimal_powers();
+	std::vector<uint64_t> ret;
+
+	if (length > DECIMAL_CHUNK_DIGITS * DECIMAL_DC_THRESHOLD){
+		// the biggest power with no more than half the digits
+		auto k = 0u;
+		while (k + 1u < powers.size() && 2u * (DECIMAL_CHUNK_DIGITS << (k + 1u)) <= length) ++k;
+
+		const auto& power = powers[k];
+		size_t low_length = DECIMAL_CHUNK_DIGITS << k;
+		auto high = decimal_value(str, length - low_length);
+		auto low = decimal_value(str + length - low_length, low_length);
+
+		if (high.empty()) return low;
+
+		// high * 10^low_length + low
+		ret.assign(high.size() + power.size(), 0ull);
+		limbs_mul(ret.data(), high.data(), static_cast<uint16_t>(high.size()), power.data(), static_cast<uint16_t>(power.size()));
+		if (!low.empty())
+			limbs_add(ret.data(), ret.data(), static_cast<uint16_t>(ret.size()), low.data(), static_cast<uint16_t>(low.size()));
+		trim_limbs(&ret);
+		return ret;
+	}
+
+	// horner's rule on chunks of 19 digits, the first chunk takes what is left over
+	auto chunk_length = length % DECIMAL_CHUNK_DIGITS;
+	if (!chunk_length) chunk_length = DECIMAL_CHUNK_DIGITS;
+
+	for (size_t i = 0u; i < length; i += chunk_length, chunk_length = DECIMAL_CHUNK_DIGITS){
+		uint64_t value = 0ull;
+		uint64_t carry;
+
+		for (auto j = 0u; j < chunk_length; ++j) value = value * 10u + static_cast<uint64_t>(str[i + j] - '0');
+
+		auto size = static_cast<uint16_t>(ret.size());
+		carry = limbs_mul_1(ret.data(), ret.data(), size, DECIMAL_CHUNK);
+		if (carry) ret.push_back(carry);
+		if (ret.empty()) ret.push_back(0ull);
+		if (limbs_add(ret.data(), ret.data(), static_cast<uint16_t>(ret.size()), &value, 1u)) ret.push_back(1ull);
+	}
+	trim_limbs(&ret);
+	return ret;
+}
+
+/*
+returns the value of the digit c, or 255 if it is not one
+*/
+static uint8_t digit_value(char c){
+	if (c >= '0' && c <= '9') return static_cast<uint8_t>(c - '0');
+	if (c >= 'a' && c <= 'f') return static_cast<uint8_t>(c - 'a' + 10);
+	if (c >= 'A' && c <= 'F') return static_cast<uint8_t>(c - 'A' + 10);
+	return 255u;
+}
+
+/*
+returns the number of bits per digit for the power of 2 bases,
+0 for base 10. throws for the ones that are not supported
+*/
+static uint8_t base_bits(uint8_t base){
+	switch (base){
+	case 2u: return 1u;
+	case 8u: return 3u;
+	case 10u: return 0u;
+	case 16u: return 4u;
+	default: throw std::invalid_argument("uint_t: base must be 2, 8, 10 or 16");
+	}
+}
+
+template <uint16_t Bits>
+std::string uint_t<Bits>::to_string(uint8_t base) const{
+	static const char digits[] = "0123456789abcdef";
+	std::string ret;
+	uint16_t bits;
+	uint8_t step;
+	size_t width;
+
+	step = base_bits(base);
+	if (!size_) return "0";
+	bits = num_bits();
+
+	if (step){
+		// a straight walk over the bits, lowest digit last
+		width = (bits + step - 1u) / step;
+		ret.resize(width);
+		for (size_t i = 0u; i < width; ++i)
+			ret[width - 1u - i] = digits[bits_at(static_cast<uint16_t>(i * step)) & ((1u << step) - 1u)];
+		return ret;
+	}
+
+	// log10(2) < 0.30103, so this is at least the number of digits
+	width = static_cast<size_t>(bits) * 30103u / 100000u + 1u;
+	ret.assign(width, '0');
+	decimal_digits(std::vector<uint64_t>(parts_, parts_ + size_), &ret[0], width);
+	ret.erase(0u, ret.find_first_not_of('0'));
+	return ret;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> uint_t<Bits>::from_string(const std::string& str, uint8_t base){
+	uint_t ret;
+	size_t first, length;
+	uint8_t step;
+
+	step = base_bits(base);
+	if (str.empty()) throw std::invalid_argument("uint_t: empty string");
+	for (auto c : str){
+		if (digit_value(c) >= base) throw std::invalid_argument("uint_t: invalid digit");
+	}
+
+	first = str.find_first_not_of('0');
+	if (first == std::string::npos) return ret;
+	length = str.size() - first;
+
+	if (step){
+		uint32_t position = 0u;
+
+		// lowest digit first, 'step' bits each
+		for (auto i = str.size(); i-- > first; position += step){
+			uint64_t digit = digit_value(str[i]);
+
+			if (!digit) continue;
+			if (position >= Bits || (position + step > Bits && (digit >> (Bits - position))))
+				throw std::out_of_range("uint_t: number does not fit");
+
+			ret.parts_[position / 64u] |= digit << (position % 64u);
+			// a digit that straddles two limbs
+			if (position % 64u + step > 64u && position / 64u + 1u < Limbs)
+				ret.parts_[position / 64u + 1u] |= digit >> (64u - position % 64u);
+		}
+		ret.trim(Limbs);
+		return ret;
+	}
+
+	// log10(2^Bits) < Bits * 0.30103 + 1, longer strings can not fit
+	if (length > static_cast<size_t>(Bits) * 30103u / 100000u + 1u)
+		throw std::out_of_range("uint_t: number does not fit");
+
+	auto limbs = decimal_value(str.data() + first, length);
+	if (limbs.size() > Limbs) throw std::out_of_range("uint_t: number does not fit");
+	ret.set_limbs(limbs.data(), static_cast<uint16_t>(limbs.size()));
+	return ret;
 }
 
 // --- operators ---
 
 // - assignment -
 
-uint2048& operator+=(uint2048& operand_a, const uint2048& operand_b){
-	uint64_t a, b;
-	uint64_t* c;
-	uint8_t carry_flag = 0u;
+template <uint16_t Bits>
+uint_t<Bits>& operator+=(uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	BIGNUM_INSTRUMENT_SCOPE(add, operand_a.size_ + operand_b.size_);
 
-	for (auto i = 0u; i < 32u; ++i){
-		a = operand_a.parts_[i];
-		b = operand_b.parts_[i];
-		c = &(operand_a.parts_[i]);
+	uint16_t size;
+	uint8_t carry_flag;
 
-		// intrinsic function
-		// adcx instruction
-		// *c = a + b + carry
-		// carry_flag is set to 1 if there is a carry bit
-		carry_flag = _addcarry_u64(carry_flag, a, b, c);
+	// limbs above both sizes are zero on both sides, only add the live ones
+	size = (operand_a.size_ > operand_b.size_) ? operand_a.size_ : operand_b.size_;
+
+	// small widths add every limb in one unrolled pass, the carry out of
+	// the top is dropped like below
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MAX){
+		limbs_add_n<uint_t<Bits>::Limbs>(operand_a.parts_, operand_a.parts_, operand_b.parts_);
+		operand_a.trim((size < uint_t<Bits>::Limbs) ? size + 1u : uint_t<Bits>::Limbs);
+		return operand_a;
 	}
 
+	carry_flag = limbs_add(operand_a.parts_, operand_a.parts_, size, operand_b.parts_, size);
+
+	if (carry_flag && size < uint_t<Bits>::Limbs){
+		operand_a.parts_[size] = 1ull;
+		operand_a.size_ = size + 1u;
+	}
+	else operand_a.trim(size);
+
 	return operand_a;
 }
-uint2048& operator+=(uint2048& operand_a, uint64_t operand_b){
+template <uint16_t Bits>
+uint_t<Bits>& operator+=(uint_t<Bits>& operand_a, uint64_t operand_b){
 	uint64_t a;
 	uint64_t* b;
 	uint8_t carry_flag = 0u;
+	auto i = 0u;
 
 	a = operand_a.parts_[0u];
 	b = &(operand_a.parts_[0u]);
@@ -104,535 +519,899 @@ uint2048& operator+=(uint2048& operand_a, uint64_t operand_b){
 	// carry_flag is set to 1 if there is a carry bit
 	carry_flag = _addcarry_u64(carry_flag, a, operand_b, b);
 
-	if (carry_flag){
-		for (auto i = 1u; i < 32u; ++i){
-			a = operand_a.parts_[i];
-			b = &(operand_a.parts_[i]);
+	while (carry_flag && ++i < uint_t<Bits>::Limbs){
+		a = operand_a.parts_[i];
+		b = &(operand_a.parts_[i]);
+
+		// intrinsic function
+		// adcx instruction
+		// *c = a + b + carry
+		carry_flag = _addcarry_u64(carry_flag, a, 0, b);
+	}
 
-			// intrinsic function
-			// adcx instruction
-			// *c = a + b + carry
-			carry_flag = _addcarry_u64(carry_flag, a, 0, b);
+	// i is the last limb that changed
+	if (i >= operand_a.size_) operand_a.size_ = (i < uint_t<Bits>::Limbs) ? i + 1u : uint_t<Bits>::Limbs;
+	if (carry_flag || !operand_a.parts_[operand_a.size_ - 1u]) operand_a.trim(operand_a.size_);
 
-			if (!carry_flag) break;
-		}
+	return operand_a;
+}
+
+template <uint16_t Bits>
+uint_t<Bits>& operator-=(uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	BIGNUM_INSTRUMENT_SCOPE(sub, operand_a.size_ + operand_b.size_);
+
+	uint16_t size;
+	uint8_t borrow_flag;
+
+	size = (operand_a.size_ > operand_b.size_) ? operand_a.size_ : operand_b.size_;
+
+	// the borrow runs through the limbs above size by itself
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MAX){
+		borrow_flag = limbs_sub_n<uint_t<Bits>::Limbs>(operand_a.parts_, operand_a.parts_, operand_b.parts_);
+		operand_a.trim(borrow_flag ? uint_t<Bits>::Limbs : size);
+		return operand_a;
+	}
+
+	borrow_flag = limbs_sub(operand_a.parts_, operand_a.parts_, size, operand_b.parts_, size);
+
+	if (borrow_flag){
+		// the result wrapped around 2^Bits,
+		// the borrow runs through every limb above
+		for (auto i = size; i < uint_t<Bits>::Limbs; ++i) operand_a.parts_[i] = ~0ull;
+		operand_a.trim(uint_t<Bits>::Limbs);
 	}
+	else operand_a.trim(size);
 
 	return operand_a;
 }
 
-uint2048& operator-=(uint2048& operand_a, const uint2048& operand_b){
-	uint64_t a, b;
-	uint64_t* c;
-	uint8_t borrow_flag = 0u;
+template <uint16_t Bits>
+uint_t<Bits>& operator*=(uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	mul(operand_a, operand_b, &operand_a);
+	return operand_a;
+}
+template <uint16_t Bits>
+uint_t<Bits>& operator*=(uint_t<Bits>& operand_a, uint64_t operand_b){
+	BIGNUM_INSTRUMENT_SCOPE(mul_1, operand_a.size_);
 
-	for (auto i = 0u; i < 32u; ++i){
-		a = operand_a.parts_[i];
-		b = operand_b.parts_[i];
-		c = &(operand_a.parts_[i]);
+	uint64_t carry;
+	uint16_t size;
 
-		// intrinsic function
-		// sbb instruction
-		// *c = a - (b + borrow)
-		// borrow_flag is set to 1 if (a < (b + borrow))
-		borrow_flag = _subborrow_u64(borrow_flag, a, b, c);
+	size = operand_a.size_;
+	carry = limbs_mul_1(operand_a.parts_, operand_a.parts_, size, operand_b);
+
+	// the product is at most one limb longer, unless that limb is past the top
+	if (carry && size < uint_t<Bits>::Limbs){
+		operand_a.parts_[size] = carry;
+		operand_a.size_ = size + 1u;
 	}
+	else operand_a.trim(size);
+
 	return operand_a;
 }
 
-uint2048& operator%=(uint2048& operand_dividend, const uint2048& operand_divisor){
-	uint2048 quotient;
+template <uint16_t Bits>
+uint_t<Bits>& operator/=(uint_t<Bits>& operand_dividend, const uint_t<Bits>& operand_divisor){
+	if (!divmod(operand_dividend, operand_divisor, &operand_dividend, nullptr))
+		throw std::domain_error("uint_t: division by zero");
+	return operand_dividend;
+}
+template <uint16_t Bits>
+uint_t<Bits>& operator/=(uint_t<Bits>& operand_dividend, uint64_t operand_divisor){
+	return operand_dividend /= U64Divisor{ operand_divisor };
+}
+template <uint16_t Bits>
+uint_t<Bits>& operator/=(uint_t<Bits>& operand_dividend, const U64Divisor& operand_divisor){
+	BIGNUM_INSTRUMENT_SCOPE(div_1, operand_dividend.size_);
+
+	limbs_divmod_1_preinv(operand_dividend.parts_, operand_dividend.parts_, operand_dividend.size_,
+		operand_divisor.normalized(), operand_divisor.shift(), operand_divisor.reciprocal());
+	operand_dividend.trim(operand_dividend.size_);
+	return operand_dividend;
+}
 
-	if (operand_dividend < operand_divisor) return operand_dividend;
-	quotient = operand_dividend / operand_divisor;
-	operand_dividend -= (operand_divisor * quotient);
+template <uint16_t Bits>
+uint_t<Bits>& operator%=(uint_t<Bits>& operand_dividend, const uint_t<Bits>& operand_divisor){
+	if (!divmod(operand_dividend, operand_divisor, nullptr, &operand_dividend))
+		throw std::domain_error("uint_t: division by zero");
 	return operand_dividend;
 }
 
-uint2048& operator<<=(uint2048& operand_a, uint16_t operand_b){
-	if (operand_b >= 2048u){
-		for (auto i = 0u; i < 32u; ++i) operand_a.parts_[i] = 0ull;
+template <uint16_t Bits>
+uint_t<Bits>& operator&=(uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	uint16_t size;
+
+	// anything above the shorter operand is masked to zero
+	size = (operand_a.size_ < operand_b.size_) ? operand_a.size_ : operand_b.size_;
+	limbs_and(operand_a.parts_, operand_a.parts_, operand_b.parts_, size);
+	limbs_zero(operand_a.parts_ + size, operand_a.size_ - size);
+	operand_a.trim(size);
+	return operand_a;
+}
+
+template <uint16_t Bits>
+uint_t<Bits>& operator|=(uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	uint16_t size;
+
+	// or-ing zero limbs above both sizes would not change them
+	size = (operand_a.size_ > operand_b.size_) ? operand_a.size_ : operand_b.size_;
+	limbs_or(operand_a.parts_, operand_a.parts_, operand_b.parts_, size);
+	operand_a.size_ = size;
+	return operand_a;
+}
+
+template <uint16_t Bits>
+uint_t<Bits>& operator^=(uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	uint16_t size;
+
+	size = (operand_a.size_ > operand_b.size_) ? operand_a.size_ : operand_b.size_;
+	limbs_xor(operand_a.parts_, operand_a.parts_, operand_b.parts_, size);
+	operand_a.trim(size);
+	return operand_a;
+}
+
+template <uint16_t Bits>
+uint_t<Bits>& operator<<=(uint_t<Bits>& operand_a, uint16_t operand_b){
+	BIGNUM_INSTRUMENT_SCOPE(shift, operand_a.size_);
+
+	if (operand_b >= Bits){
+		limbs_zero(operand_a.parts_, operand_a.size_);
+		operand_a.size_ = 0u;
 		return operand_a;
 	}
-	uint64_t a, b, c;
-	auto overflow = 0ull;
-	auto shift = operand_b / 64u;
-
-	if (shift){
-		for (auto i = 0u; i < (32u - shift); ++i) operand_a.parts_[31u - i] = operand_a.parts_[31u - i - shift];
-		for (auto i = 0u; i < shift; ++i) operand_a.parts_[i] = 0ull;
-	}
-	if (operand_b %= 64u){
-		for (auto i = 0u; i < 32u; ++i){
-			a = operand_a.parts_[i];
-			b = a << operand_b;
-			c = b + overflow;
-			overflow = a >> (64u - operand_b);
-			operand_a.parts_[i] = c;
-		}
-	}
+	if (!operand_a.size_) return operand_a;
+
+	uint16_t shift, bits, size;
+	uint64_t carry;
 
+	shift = operand_b / 64u;
+	bits = operand_b % 64u;
+
+	// limbs that would move past the top are dropped
+	size = operand_a.size_;
+	if (size > uint_t<Bits>::Limbs - shift) size = uint_t<Bits>::Limbs - shift;
+
+	carry = limbs_shl(operand_a.parts_ + shift, operand_a.parts_, size, bits);
+	limbs_zero(operand_a.parts_, shift);
+
+	// the bits shifted out of the top limb start a new one
+	size += shift;
+	if (carry && size < uint_t<Bits>::Limbs) operand_a.parts_[size++] = carry;
+
+	operand_a.trim(size);
 	return operand_a;
 }
-uint2048& operator>>=(uint2048& operand_a, uint16_t operand_b){
-	// if the input is greater than or equal to 2048
+template <uint16_t Bits>
+uint_t<Bits>& operator>>=(uint_t<Bits>& operand_a, uint16_t operand_b){
+	BIGNUM_INSTRUMENT_SCOPE(shift, operand_a.size_);
+
+	// if the input is greater than or equal to Bits
 	//   set all unsigned long longs in parts_ to zero
 	//   return reference to *this
-	if (operand_b >= 2048u){
-		for (auto i = 0u; i < 32u; ++i) operand_a.parts_[i] = 0ull;
+	if (operand_b >= Bits || operand_b / 64u >= operand_a.size_){
+		limbs_zero(operand_a.parts_, operand_a.size_);
+		operand_a.size_ = 0u;
 		return operand_a;
 	}
 
-	uint64_t a, b, c;
+	uint16_t shift, bits, size;
 
-	auto overflow = 0ull;
-	auto shift = operand_b / 64u;
+	shift = operand_b / 64u;
+	bits = operand_b % 64u;
+	size = operand_a.size_ - shift;
 
-	if (shift){
-		for (auto i = 0u; i < (32u - shift); ++i)
-			operand_a.parts_[i] = operand_a.parts_[i + shift];
-		for (auto i = 0u; i < shift; ++i)
-			operand_a.parts_[31u - i] = 0ull;
-	}
-	if (operand_b %= 64u)
-		for (auto i = 0u; i < 32u; ++i){
-			a = operand_a.parts_[31u - i];
-			b = a >> operand_b;
-			c = b + overflow;
-			overflow = a << (64u - operand_b);
-			operand_a.parts_[31u - i] = c;
-		}
+	limbs_shr(operand_a.parts_, operand_a.parts_ + shift, size, bits);
+	limbs_zero(operand_a.parts_ + size, shift);
+
+	operand_a.trim(size);
 	return operand_a;
 }
 
 // - increment / decrement -
 
-uint2048& uint2048::operator++(){
-	uint64_t a;
-	uint64_t* b;
-	uint8_t carry_flag = 0u;
+template <uint16_t Bits>
+uint_t<Bits>& uint_t<Bits>::operator++(){
+	return *this += 1ull;
+}
+template <uint16_t Bits>
+uint_t<Bits> uint_t<Bits>::operator++(int){
+	uint_t<Bits> ret;
 
-	a = parts_[0];
-	b = &(parts_[0]);
+	ret = *this;
+	*this += 1ull;
+	return ret;
+}
 
-	// intrinsic function
-	// adcx instruction
-	// *c = a + b + carry
-	// carry_flag is set to 1 if there is a carry bit
-	carry_flag = _addcarry_u64(carry_flag, a, 1ull, b);
+// - arithmetic -
 
-	if (carry_flag)
-		for (auto i = 1u; i < 32u; ++i){
-			a = parts_[i];
-			b = &(parts_[i]);
+template <uint16_t Bits>
+uint_t<Bits> operator+(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	BIGNUM_INSTRUMENT_SCOPE(add, operand_a.size_ + operand_b.size_);
 
-			// intrinsic function
-			// adcx instruction
-			// *c = a + b + carry
-			// carry_flag is set to 1 if there is a carry bit
-			carry_flag = _addcarry_u64(carry_flag, a, 0, b);
+	uint_t<Bits> ret;
+	uint16_t size;
+	uint8_t carry_flag;
 
-			if (!carry_flag) break;
-		}
-	return *this;
-}
-uint2048 uint2048::operator++(int){
-	uint2048 ret;
-	uint64_t a;
-	uint64_t* b;
-	uint8_t carry_flag = 0u;
+	size = (operand_a.size_ > operand_b.size_) ? operand_a.size_ : operand_b.size_;
 
-	ret = *this;
-	a = parts_[0];
-	b = &(parts_[0]);
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MAX){
+		limbs_add_n<uint_t<Bits>::Limbs>(ret.parts_, operand_a.parts_, operand_b.parts_);
+		ret.trim((size < uint_t<Bits>::Limbs) ? size + 1u : uint_t<Bits>::Limbs);
+		return ret;
+	}
 
-	// intrinsic function
-	// adcx instruction
-	// *c = a + b + carry
-	// carry_flag is set to 1 if there is a carry bit
-	carry_flag = _addcarry_u64(carry_flag, a, 1ull, b);
+	carry_flag = limbs_add(ret.parts_, operand_a.parts_, size, operand_b.parts_, size);
 
-	if (carry_flag)
-		for (auto i = 1u; i < 32u; ++i){
-			a = parts_[i];
-			b = &(parts_[i]);
+	if (carry_flag && size < uint_t<Bits>::Limbs){
+		ret.parts_[size] = 1ull;
+		ret.size_ = size + 1u;
+	}
+	else ret.trim(size);
+	return ret;
+}
+template <uint16_t Bits>
+uint_t<Bits> operator+(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	uint_t<Bits> ret;
 
-			// intrinsic function
-			// adcx instruction
-			// *c = a + b + carry
-			// carry_flag is set to 1 if there is a carry bit
-			carry_flag = _addcarry_u64(carry_flag, a, 0, b);
+	ret = operand_a;
+	ret += operand_b;
+	return ret;
+}
+template <uint16_t Bits>
+uint_t<Bits> operator+(uint64_t operand_a, const uint_t<Bits>& operand_b){
+	uint_t<Bits> ret;
 
-			if (!carry_flag) break;
-		}
+	ret = operand_b;
+	ret += operand_a;
 	return ret;
 }
 
-// - arithmetic -
+template <uint16_t Bits>
+uint_t<Bits> operator-(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	BIGNUM_INSTRUMENT_SCOPE(sub, operand_a.size_ + operand_b.size_);
 
-uint2048 operator+(const uint2048& operand_a, const uint2048& operand_b){
-	uint2048 ret;
-	uint64_t a, b;
-	uint64_t* c;
-	uint8_t carry_flag = 0u;
+	uint_t<Bits> ret;
+	uint16_t size;
+	uint8_t borrow_flag;
 
-	for (auto i = 0u; i < 32u; ++i){
-		a = operand_a.parts_[i];
-		b = operand_b.parts_[i];
-		c = &(ret.parts_[i]);
+	size = (operand_a.size_ > operand_b.size_) ? operand_a.size_ : operand_b.size_;
 
-		// intrinsic function
-		// adcx instruction
-		// *c = a + b + carry
-		// carry_flag is set to 1 if there is a carry bit
-		carry_flag = _addcarry_u64(carry_flag, a, b, c);
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MAX){
+		borrow_flag = limbs_sub_n<uint_t<Bits>::Limbs>(ret.parts_, operand_a.parts_, operand_b.parts_);
+		ret.trim(borrow_flag ? uint_t<Bits>::Limbs : size);
+		return ret;
+	}
+
+	borrow_flag = limbs_sub(ret.parts_, operand_a.parts_, size, operand_b.parts_, size);
+
+	if (borrow_flag){
+		for (auto i = size; i < uint_t<Bits>::Limbs; ++i) ret.parts_[i] = ~0ull;
+		ret.trim(uint_t<Bits>::Limbs);
 	}
+	else ret.trim(size);
 	return ret;
 }
-uint2048 operator+(const uint2048& operand_a, uint64_t operand_b){
-	uint2048 ret;
+template <uint16_t Bits>
+uint_t<Bits> operator-(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	uint_t<Bits> ret;
 	uint64_t a;
 	uint64_t* b;
-	uint8_t carry_flag = 0u;
+	uint8_t borrow_flag = 0u;
+	auto i = 0u;
 
-	a = operand_a.parts_[0u];
-	b = &(ret.parts_[0u]);
+	ret = operand_a;
+	a = ret.parts_[0];
+	b = &(ret.parts_[0]);
 
 	// intrinsic function
-	// adcx instruction
-	// *c = a + b + carry
-	// carry_flag is set to 1 if there is a carry bit
-	carry_flag = _addcarry_u64(carry_flag, a, operand_b, b);
-
-	if (carry_flag){
-		for (auto i = 1u; i < 32u; ++i){
-			a = operand_a.parts_[i];
-			b = &(ret.parts_[i]);
+	// sbb instruction
+	// *c = a - (num + borrow)
+	// borrow_flag is set to 1 if (a < (b + borrow))
+	borrow_flag = _subborrow_u64(borrow_flag, a, operand_b, b);
 
-			// intrinsic function
-			// adcx instruction
-			// *c = a + b + carry
-			carry_flag = _addcarry_u64(carry_flag, a, 0, b);
+	while (borrow_flag && ++i < uint_t<Bits>::Limbs){
+		a = ret.parts_[i];
+		b = &(ret.parts_[i]);
 
-			if (!carry_flag) break;
-		}
+		// intrinsic function
+		// sbb instruction
+		// *b = a - borrow
+		// borrow_flag is set to 1 if (a < (b + borrow))
+		borrow_flag = _subborrow_u64(borrow_flag, a, 0, b);
 	}
-		
+
+	// a borrow out of the top wrapped every limb, otherwise the result
+	// is no bigger than operand_a
+	ret.trim(borrow_flag ? uint_t<Bits>::Limbs : ret.size_);
 	return ret;
 }
-uint2048 operator+(uint64_t operand_a, const uint2048& operand_b){
-	uint2048 ret;
-	uint64_t a;
-	uint64_t* b;
-	uint8_t carry_flag = 0u;
 
-	a = operand_b.parts_[0u];
-	b = &(ret.parts_[0u]);
+template <uint16_t Bits>
+uint_t<Bits> operator*(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	uint_t<Bits> ret;
 
-	// intrinsic function
-	// adcx instruction
-	// *c = a + b + carry
-	// carry_flag is set to 1 if there is a carry bit
-	carry_flag = _addcarry_u64(carry_flag, a, operand_a, b);
+	mul(operand_a, operand_b, &ret);
+	return ret;
+}
 
-	if (carry_flag){
-		for (auto i = 1u; i < 32u; ++i){
-			a = operand_b.parts_[i];
-			b = &(ret.parts_[i]);
+template <uint16_t Bits>
+uint_t<Bits> operator*(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	uint_t<Bits> ret;
 
-			// intrinsic function
-			// adcx instruction
-			// *c = a + b + carry
-			carry_flag = _addcarry_u64(carry_flag, a, 0, b);
+	ret = operand_a;
+	ret *= operand_b;
+	return ret;
+}
+template <uint16_t Bits>
+uint_t<Bits> operator*(uint64_t operand_a, const uint_t<Bits>& operand_b){
+	uint_t<Bits> ret;
 
-			if (!carry_flag) break;
-		}
-	}
+	ret = operand_b;
+	ret *= operand_a;
+	return ret;
+}
 
+template <uint16_t Bits>
+uint_t<Bits> operator/(const uint_t<Bits>& operand_dividend, const uint_t<Bits>& operand_divisor){
+	uint_t<Bits> quotient;
+
+	if (!divmod(operand_dividend, operand_divisor, &quotient, nullptr))
+		throw std::domain_error("uint_t: division by zero");
+	return quotient;
+}
+template <uint16_t Bits>
+uint_t<Bits> operator/(const uint_t<Bits>& operand_dividend, uint64_t operand_divisor){
+	uint_t<Bits> ret;
+
+	ret = operand_dividend;
+	ret /= operand_divisor;
 	return ret;
 }
+template <uint16_t Bits>
+uint_t<Bits> operator/(const uint_t<Bits>& operand_dividend, const U64Divisor& operand_divisor){
+	uint_t<Bits> ret;
 
-uint2048 operator-(const uint2048& operand_a, const uint2048& operand_b){
-	uint2048 ret;
-	uint64_t a, b;
-	uint64_t* c;
-	uint8_t borrow_flag = 0u;
+	ret = operand_dividend;
+	ret /= operand_divisor;
+	return ret;
+}
 
-	for (auto i = 0u; i < 32u; ++i){
-		a = operand_a.parts_[i];
-		b = operand_b.parts_[i];
-		c = &(ret.parts_[i]);
+template <uint16_t Bits>
+uint_t<Bits> operator%(const uint_t<Bits>& operand_dividend, const uint_t<Bits>& operand_divisor){
+	uint_t<Bits> remainder;
 
-		// intrinsic function
-		// sbb instruction
-		// *c = a - (b + borrow)
-		// borrow_flag is set to 1 if (a < (b + borrow))
-		borrow_flag = _subborrow_u64(borrow_flag, a, b, c);
-	}
+	if (!divmod(operand_dividend, operand_divisor, nullptr, &remainder))
+		throw std::domain_error("uint_t: division by zero");
+	return remainder;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> operator&(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	uint_t<Bits> ret;
+	uint16_t size;
+
+	// anything above the shorter operand is masked to zero
+	size = (operand_a.size_ < operand_b.size_) ? operand_a.size_ : operand_b.size_;
+	limbs_and(ret.parts_, operand_a.parts_, operand_b.parts_, size);
+	ret.trim(size);
 	return ret;
 }
-uint2048 operator-(const uint2048& operand_a, uint64_t operand_b){
-	uint2048 ret;
+template <uint16_t Bits>
+uint64_t operator&(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	uint64_t ret;
 	uint64_t a;
-	uint64_t* b;
-	uint8_t borrow_flag = 0u;
 
-	a = operand_a.parts_[0];
-	b = &(ret.parts_[0]);
+	a = operand_a.parts_[0u];
+	ret = a & operand_b;
+	return ret;
+}
 
-	// intrinsic function
-	// sbb instruction
-	// *c = a - (num + borrow)
-	// borrow_flag is set to 1 if (a < (b + borrow))
-	borrow_flag = _subborrow_u64(borrow_flag, a, operand_b, b);
+template <uint16_t Bits>
+uint_t<Bits> operator|(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	uint_t<Bits> ret;
+	uint16_t size;
 
-	if (borrow_flag){
-		for (auto i = 1u; i < 32u; ++i){
-			a = operand_a.parts_[i];
-			b = &(ret.parts_[i]);
+	size = (operand_a.size_ > operand_b.size_) ? operand_a.size_ : operand_b.size_;
+	limbs_or(ret.parts_, operand_a.parts_, operand_b.parts_, size);
+	ret.size_ = size;
+	return ret;
+}
 
-			// intrinsic function
-			// sbb instruction
-			// *b = a - borrow
-			// borrow_flag is set to 1 if (a < (b + borrow))
-			borrow_flag = _subborrow_u64(borrow_flag, a, 0, b);
+template <uint16_t Bits>
+uint_t<Bits> operator^(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	uint_t<Bits> ret;
+	uint16_t size;
 
-			if (!borrow_flag) break;
-		}
-	}
-	else{
-		for (auto i = 1u; i < 32u; ++i) ret.parts_[i] = operand_a.parts_[i];
-	}
+	size = (operand_a.size_ > operand_b.size_) ? operand_a.size_ : operand_b.size_;
+	limbs_xor(ret.parts_, operand_a.parts_, operand_b.parts_, size);
+	ret.trim(size);
 	return ret;
 }
 
-uint2048 operator*(const uint2048& operand_a, const uint2048& operand_b){
-	uint2048 ret;
+template <uint16_t Bits>
+uint_t<Bits> operator~(const uint_t<Bits>& operand_a){
+	uint_t<Bits> ret;
 
-	if (operand_b == 0ull || operand_a == 0ull) return ret;
-	if (operand_b == 1ull) return operand_a;
-	if (operand_a == 1ull) return operand_b;
+	// the zero limbs above size_ become ones, so every limb takes part
+	limbs_not(ret.parts_, operand_a.parts_, uint_t<Bits>::Limbs);
+	ret.trim(uint_t<Bits>::Limbs);
+	return ret;
+}
 
-	uint2048 temp_a, temp_b;
-	uint16_t num_loops;
+template <uint16_t Bits>
+uint_t<Bits> operator<<(const uint_t<Bits>& operand_a, uint16_t operand_b){
+	uint_t<Bits> ret;
 
-	num_loops = operand_b.num_bits();
-	temp_a = operand_b;
-	temp_b = operand_a;
-	for (auto i = 0u; i < num_loops; ++i){
-		if (temp_a & 1ull) ret += temp_b;
-		temp_a >>= 1u;
-		temp_b <<= 1u;
-	}
+	ret = operand_a;
+	ret <<= operand_b;
 	return ret;
 }
+template <uint16_t Bits>
+uint_t<Bits> operator>>(const uint_t<Bits>& operand_a, uint16_t operand_b){
+	uint_t<Bits> ret;
 
-uint2048 operator/(const uint2048& operand_dividend, const uint2048& operand_divisor){
-	uint2048 quotient;
-	// ! need better way to handle division by 0, expections are gross
-	// perhaps an error flag in the object?
-	if (operand_divisor > operand_dividend || operand_divisor == 0ull) return quotient;
-	uint2048 dividend, remainder;
-	uint2048 offering;
-	uint16_t dividend_bits, divisor_bits, remainder_bits;
-	uint16_t bits_from_dividend;
-
-	dividend = operand_dividend;
-	dividend_bits = dividend.num_bits();
-	divisor_bits = operand_divisor.num_bits();
-	remainder_bits = 0u;
-
-	// loop while there are more bits to divide into
-	while ((dividend_bits + remainder_bits) >= divisor_bits){
-
-		// determine how many bits are needed from the dividend
-		bits_from_dividend = divisor_bits - remainder_bits;
-
-		// if there are remainder bits
-		if (remainder_bits){
-			// push the remainder into the offering with trailing zeros
-			// equal to the number of bits from the dividend
-			offering = remainder << bits_from_dividend;
-
-			// take the the most significant bits from the dividend
-			// and add them to the offering.
-			// the number of bits to take from the dividend are equal to
-			// bits_from_dividend
-			offering += (dividend >> (dividend_bits - bits_from_dividend));
-		}
-		else{
-			// there are no remainder bits to add to the offering.
-			// only take bits from the dividend
-			offering = dividend >> (dividend_bits - bits_from_dividend);
-		}
+	ret = operand_a;
+	ret >>= operand_b;
+	return ret;
+}
+
+// - comparison -
+
+template <uint16_t Bits>
+bool operator==(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	BIGNUM_INSTRUMENT_SCOPE(compare, operand_a.size_ + operand_b.size_);
+
+	if (operand_a.size_ != operand_b.size_) return false;
+	return !limbs_cmp(operand_a.parts_, operand_b.parts_, operand_a.size_);
+}
+template <uint16_t Bits>
+bool operator==(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	if (operand_a.size_ > 1u) return false;
+	return operand_a.parts_[0] == operand_b;
+}
+
+template <uint16_t Bits>
+bool operator!=(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	return !(operand_a == operand_b);
+}
+template <uint16_t Bits>
+bool operator!=(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	return !(operand_a == operand_b);
+}
 
-		// chop off the most significant bits from the dividend.
-		// takes a number of bits equal to bits_from_dividend
-		dividend <<= (2048u - (dividend_bits - bits_from_dividend));
-		dividend >>= (2048u - (dividend_bits - bits_from_dividend));
+template <uint16_t Bits>
+bool operator<(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	BIGNUM_INSTRUMENT_SCOPE(compare, operand_a.size_ + operand_b.size_);
 
-		// push the bits in quotient to the left by bits_from_dividend
-		quotient <<= bits_from_dividend;
+	// more live limbs means a bigger number
+	if (operand_a.size_ != operand_b.size_) return operand_a.size_ < operand_b.size_;
+	return limbs_cmp(operand_a.parts_, operand_b.parts_, operand_a.size_) < 0;
+}
+template <uint16_t Bits>
+bool operator<(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	if (operand_a.size_ > 1u) return false;
+	return operand_a.parts_[0] < operand_b;
+}
+
+template <uint16_t Bits>
+bool operator>(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	return operand_b < operand_a;
+}
+template <uint16_t Bits>
+bool operator>(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	if (operand_a.size_ > 1u) return true;
+	return operand_a.parts_[0] > operand_b;
+}
 
-		// calculate the number of bits left in the dividend
-		dividend_bits = dividend_bits - bits_from_dividend;
+template <uint16_t Bits>
+bool operator<=(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	return !(operand_b < operand_a);
+}
+template <uint16_t Bits>
+bool operator<=(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	return !(operand_a > operand_b);
+}
 
-		// loop until the offering is greater than or equal to
-		// the divisor
-		while (offering < operand_divisor){
-			// if there are no more bits in the dividend return the quotient
-			if (!dividend_bits) return quotient;
+template <uint16_t Bits>
+bool operator>=(const uint_t<Bits>& operand_a, const uint_t<Bits>& operand_b){
+	return !(operand_a < operand_b);
+}
+template <uint16_t Bits>
+bool operator>=(const uint_t<Bits>& operand_a, uint64_t operand_b){
+	return !(operand_a < operand_b);
+}
 
-			// shift the bits in the offering 1 to the left
-			offering <<= 1u;
 
-			// add the most significant bit in the dividend to the offering
-			offering += (dividend >> (dividend_bits - 1u));
+// --- static functions ---
 
-			// chop off the most significant bit from the dividend
-			dividend <<= (2049u - dividend_bits);
-			dividend >>= (2049u - dividend_bits);
+template <uint16_t Bits>
+void mul(const uint_t<Bits>& a, const uint_t<Bits>& b, typename non_deduced<uint_t<Bits>>::type* result){
+	BIGNUM_INSTRUMENT_SCOPE(mul, a.size_ + b.size_);
 
-			// shift the bits in the quotient 1 to the left
-			quotient <<= 1u;
+	uint64_t product[2u * uint_t<Bits>::Limbs];
+	uint16_t size_a, size_b, size;
 
-			// decrement dividend_bits
-			--dividend_bits;
+	// only the limbs up to and including the most significant
+	// non-zero limb take part in the multiplication
+	size_a = a.size_;
+	size_b = b.size_;
+	if (!size_a || !size_b){
+		result->set_limbs(product, 0u);
+		return;
+	}
+	size = size_a + size_b;
+
+	// a product that does not fit a small width only needs its low limbs
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MAX){
+		if (size > uint_t<Bits>::Limbs){
+			limbs_mullo_n<uint_t<Bits>::Limbs>(product, a.parts_, b.parts_);
+			result->set_limbs(product, uint_t<Bits>::Limbs);
+			return;
 		}
+	}
 
-		// increment quotient
-		++quotient;
+	// straight into result when it is not an input and the product fits,
+	// through the stack otherwise
+	if (result != &a && result != &b && size <= uint_t<Bits>::Limbs){
+		if (result->size_ > size) limbs_zero(result->parts_ + size, result->size_ - size);
+		limbs_mul(result->parts_, a.parts_, size_a, b.parts_, size_b);
+		result->trim(size);
+		return;
+	}
+
+	// a full product that does not fit keeps the low Bits bits,
+	// same as the rest of the arithmetic
+	limbs_mul(product, a.parts_, size_a, b.parts_, size_b);
+	result->set_limbs(product, (size < uint_t<Bits>::Limbs) ? size : uint_t<Bits>::Limbs);
+}
+
+template <uint16_t Bits>
+void sqr(const uint_t<Bits>& a, typename non_deduced<uint_t<Bits>>::type* result){
+	BIGNUM_INSTRUMENT_SCOPE(sqr, a.size_);
 
-		// calculate the remainder
-		remainder = offering - operand_divisor;
+	uint64_t square[2u * uint_t<Bits>::Limbs];
+	uint16_t size_a, size;
 
-		// get the number of bits in the remainder
-		remainder_bits = remainder.num_bits();
+	size_a = a.size_;
+	if (!size_a){
+		result->set_limbs(square, 0u);
+		return;
 	}
+	size = 2u * size_a;
 
-	// shift the bits in the quotient to the left by dividend_bits
-	quotient <<= dividend_bits;
-	return quotient;
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MAX){
+		if (size > uint_t<Bits>::Limbs){
+			limbs_mullo_n<uint_t<Bits>::Limbs>(square, a.parts_, a.parts_);
+			result->set_limbs(square, uint_t<Bits>::Limbs);
+			return;
+		}
+	}
+
+	// straight into result when it is not a and the square fits
+	if (result != &a && size <= uint_t<Bits>::Limbs){
+		if (result->size_ > size) limbs_zero(result->parts_ + size, result->size_ - size);
+		limbs_sqr(result->parts_, a.parts_, size_a);
+		result->trim(size);
+		return;
+	}
+
+	limbs_sqr(square, a.parts_, size_a);
+	result->set_limbs(square, (size < uint_t<Bits>::Limbs) ? size : uint_t<Bits>::Limbs);
 }
 
-uint2048 operator%(const uint2048& operand_dividend, const uint2048& operand_divisor){
-	uint2048 quotient;
-	uint2048 remainder;
+template <uint16_t Bits>
+void mul_add(const uint_t<Bits>& a, const uint_t<Bits>& b, const uint_t<Bits>& c,
+	typename non_deduced<uint_t<Bits>>::type* result){
+	BIGNUM_INSTRUMENT_SCOPE(mul, a.size_ + b.size_ + c.size_);
+
+	uint64_t product[2u * uint_t<Bits>::Limbs];
+	uint16_t size_a, size_b, size;
+	uint8_t carry_flag;
+
+	size_a = a.size_;
+	size_b = b.size_;
+	size = (size_a && size_b) ? size_a + size_b : 0u;
+	if (size) limbs_mul(product, a.parts_, size_a, b.parts_, size_b);
+	if (size > uint_t<Bits>::Limbs) size = uint_t<Bits>::Limbs;
+
+	// add c in place, the product is widened with zeros if c is longer
+	if (size < c.size_){
+		limbs_zero(product + size, c.size_ - size);
+		size = c.size_;
+	}
+	carry_flag = limbs_add(product, product, size, c.parts_, c.size_);
+	if (carry_flag && size < uint_t<Bits>::Limbs) product[size++] = 1ull;
 
-	if (operand_dividend < operand_divisor) return operand_dividend;
-	quotient = operand_dividend / operand_divisor;
-	remainder = operand_dividend - (operand_divisor * quotient);
-	return remainder;
+	result->set_limbs(product, size);
 }
 
-uint2048 operator&(const uint2048& operand_a, const uint2048& operand_b){
-	uint2048 ret;
-	uint64_t a, b;
+template <uint16_t Bits>
+bool divmod(const uint_t<Bits>& dividend, const uint_t<Bits>& divisor,
+	typename non_deduced<uint_t<Bits>>::type* quotient, typename non_deduced<uint_t<Bits>>::type* remainder){
+	BIGNUM_INSTRUMENT_SCOPE(divmod, dividend.size_ + divisor.size_);
 
-	for (auto i = 0u; i < 32u; ++i){
-		a = operand_a.parts_[i];
-		b = operand_b.parts_[i];
-		ret.parts_[i] = a & b;
+	uint64_t q[uint_t<Bits>::Limbs];
+	uint64_t r[uint_t<Bits>::Limbs];
+	uint16_t size_a, size_b;
+
+	size_b = divisor.size_;
+	if (!size_b) return false;
+	size_a = dividend.size_;
+
+	// a dividend shorter than the divisor is the remainder as it is
+	if (size_a < size_b){
+		if (remainder && remainder != &dividend) remainder->set_limbs(dividend.parts_, size_a);
+		if (quotient) quotient->set_limbs(q, 0u);
+		return true;
 	}
-	return ret;
-}
-uint64_t operator&(const uint2048& operand_a, uint64_t operand_b){
-	uint64_t ret;
-	uint64_t a;
 
-	a = operand_a.parts_[0u];
-	ret = a & operand_b;
-	return ret;
+	// q and r are written to before the outputs so that
+	// the outputs may be the same objects as the inputs
+	limbs_divmod(quotient ? q : nullptr, r, dividend.parts_, size_a, divisor.parts_, size_b);
+	if (quotient) quotient->set_limbs(q, size_a - size_b + 1u);
+	if (remainder) remainder->set_limbs(r, size_b);
+	return true;
 }
 
-uint2048 operator<<(const uint2048& operand_a, uint16_t operand_b){
-	uint2048 ret;
-	if (operand_b >= 2048u) return ret;
-	uint64_t a, b;
-	auto overflow = 0ull;
-	auto shift = operand_b / 64u;
-
-	for (auto i = 0u; i < (32u - shift); ++i) ret.parts_[i + shift] = operand_a.parts_[i];
-	if (operand_b %= 64u)
-		for (auto i = 0u; i < 32u; ++i){
-			a = ret.parts_[i];
-			b = a << operand_b;
-			ret.parts_[i] = b + overflow;
-			overflow = a >> (64u - operand_b);
-		}
-	return ret;
+template <uint16_t Bits>
+bool mul_mod(const uint_t<Bits>& a, const uint_t<Bits>& b, const uint_t<Bits>& mod,
+	typename non_deduced<uint_t<Bits>>::type* result){
+	BIGNUM_INSTRUMENT_SCOPE(mod_arith, a.size_ + b.size_ + mod.size_);
+
+	uint64_t product[2u * uint_t<Bits>::Limbs];
+	uint64_t remainder[uint_t<Bits>::Limbs];
+	uint16_t size_a, size_b, size_m;
+
+	size_m = mod.size_;
+	if (!size_m) return false;
+
+	// everything is read before result is written to,
+	// so result may be any of the inputs
+	size_a = a.size_;
+	size_b = b.size_;
+	if (!size_a || !size_b){
+		result->set_limbs(product, 0u);
+		return true;
+	}
+
+	limbs_mul(product, a.parts_, size_a, b.parts_, size_b);
+
+	// with fewer limbs than mod the product is already reduced
+	if (size_a + size_b < size_m) result->set_limbs(product, size_a + size_b);
+	else{
+		limbs_divmod(nullptr, remainder, product, size_a + size_b, mod.parts_, size_m);
+		result->set_limbs(remainder, size_m);
+	}
+	return true;
 }
-uint2048 operator>>(const uint2048& operand_a, uint16_t operand_b){
-	uint2048 ret;
-	if (operand_b >= 2048u) return ret;
-	uint64_t a, b;
-	auto overflow = 0ull;
-	auto shift = operand_b / 64u;
-
-	for (auto i = 0u; i < (32u - shift); ++i) ret.parts_[i] = operand_a.parts_[i + shift];
-	if (operand_b %= 64u)
-		for (auto i = 0u; i < 32u; ++i){
-			a = ret.parts_[31u - i];
-			b = a >> operand_b;
-			ret.parts_[31u - i] = b + overflow;
-			overflow = a << (64u - operand_b);
-		}
-	return ret;
+
+template <uint16_t Bits>
+bool add_mod(const uint_t<Bits>& a, const uint_t<Bits>& b, const uint_t<Bits>& mod,
+	typename non_deduced<uint_t<Bits>>::type* result){
+	uint64_t sum[uint_t<Bits>::Limbs];
+	uint16_t size_m;
+	uint8_t carry_flag;
+
+	size_m = mod.size_;
+	if (!size_m) return false;
+
+	if (!(a < mod) || !(b < mod)){
+		uint_t<Bits> reduced_a, reduced_b;
+
+		divmod(a, mod, nullptr, &reduced_a);
+		divmod(b, mod, nullptr, &reduced_b);
+		return add_mod(reduced_a, reduced_b, mod, result);
+	}
+
+	BIGNUM_INSTRUMENT_SCOPE(mod_arith, a.size_ + b.size_ + mod.size_);
+
+	/*
+	a and b are below mod, so their limbs from size_m up are zero and
+	a + b < 2 * mod. one subtraction of mod is enough, and a carry out of
+	the top limb is cancelled by the borrow of that subtraction
+	*/
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MAX){
+		uint64_t reduced[uint_t<Bits>::Limbs];
+
+		// small widths subtract mod unconditionally and keep the
+		// difference unless it borrowed, no comparison
+		carry_flag = limbs_add_n<uint_t<Bits>::Limbs>(sum, a.parts_, b.parts_);
+		carry_flag |= !limbs_sub_n<uint_t<Bits>::Limbs>(reduced, sum, mod.parts_);
+		result->set_limbs(carry_flag ? reduced : sum, size_m);
+		return true;
+	}
+
+	carry_flag = limbs_add(sum, a.parts_, size_m, b.parts_, size_m);
+	if (carry_flag || limbs_cmp(sum, mod.parts_, size_m) >= 0)
+		limbs_sub(sum, sum, size_m, mod.parts_, size_m);
+
+	result->set_limbs(sum, size_m);
+	return true;
 }
 
-// - comparison -
+template <uint16_t Bits>
+bool sub_mod(const uint_t<Bits>& a, const uint_t<Bits>& b, const uint_t<Bits>& mod,
+	typename non_deduced<uint_t<Bits>>::type* result){
+	uint64_t difference[uint_t<Bits>::Limbs];
+	uint16_t size_m;
+	uint8_t borrow_flag;
+
+	size_m = mod.size_;
+	if (!size_m) return false;
 
-bool operator==(const uint2048& operand_a, const uint2048& operand_b){
-	uint64_t a, b;
-	for (auto i = 0u; i < 32u; ++i){
-		a = operand_a.parts_[31u - i];
-		b = operand_b.parts_[31u - i];
-		if (a != b) return false;
+	if (!(a < mod) || !(b < mod)){
+		uint_t<Bits> reduced_a, reduced_b;
+
+		divmod(a, mod, nullptr, &reduced_a);
+		divmod(b, mod, nullptr, &reduced_b);
+		return sub_mod(reduced_a, reduced_b, mod, result);
+	}
+
+	BIGNUM_INSTRUMENT_SCOPE(mod_arith, a.size_ + b.size_ + mod.size_);
+
+	// a - b wraps below zero when b > a, adding mod back wraps it up again
+	if constexpr (uint_t<Bits>::Limbs <= LIMBS_FIXED_MAX){
+		borrow_flag = limbs_sub_n<uint_t<Bits>::Limbs>(difference, a.parts_, b.parts_);
+		if (borrow_flag) limbs_add_n<uint_t<Bits>::Limbs>(difference, difference, mod.parts_);
+		result->set_limbs(difference, size_m);
+		return true;
 	}
+
+	borrow_flag = limbs_sub(difference, a.parts_, size_m, b.parts_, size_m);
+	if (borrow_flag) limbs_add(difference, difference, size_m, mod.parts_, size_m);
+
+	result->set_limbs(difference, size_m);
 	return true;
 }
-bool operator==(const uint2048& operand_a, uint64_t operand_b){
-	uint64_t a;
-	for (auto i = 0u; i < 31u; ++i){
-		a = operand_a.parts_[31u - i];
-		if (a != 0ull) return false;
+
+template <uint16_t Bits>
+bool sqr_mod(const uint_t<Bits>& a, const uint_t<Bits>& mod, typename non_deduced<uint_t<Bits>>::type* result){
+	BIGNUM_INSTRUMENT_SCOPE(mod_arith, a.size_ + mod.size_);
+
+	uint64_t square[2u * uint_t<Bits>::Limbs];
+	uint64_t remainder[uint_t<Bits>::Limbs];
+	uint16_t size_a, size_m;
+
+	size_m = mod.size_;
+	if (!size_m) return false;
+
+	size_a = a.size_;
+	if (!size_a){
+		result->set_limbs(square, 0u);
+		return true;
 	}
-	return operand_a.parts_[0] == operand_b;
+
+	limbs_sqr(square, a.parts_, size_a);
+
+	// with fewer limbs than mod the square is already reduced
+	if (2u * size_a < size_m) result->set_limbs(square, 2u * size_a);
+	else{
+		limbs_divmod(nullptr, remainder, square, 2u * size_a, mod.parts_, size_m);
+		result->set_limbs(remainder, size_m);
+	}
+	return true;
 }
 
-bool operator!=(const uint2048& operand_a, const uint2048& operand_b){
-	return !(operand_a == operand_b);
+template <uint16_t Bits>
+uint64_t mod_u64(const uint_t<Bits>& num, uint64_t divisor){
+	return mod_u64(num, U64Divisor{ divisor });
 }
+template <uint16_t Bits>
+uint64_t mod_u64(const uint_t<Bits>& num, const U64Divisor& divisor){
+	BIGNUM_INSTRUMENT_SCOPE(div_1, num.size_);
 
-bool operator<(const uint2048& operand_a, const uint2048& operand_b){
-	uint64_t a, b;
-	for (auto i = 0u; i < 32u; ++i){
-		a = operand_a.parts_[31u - i];
-		b = operand_b.parts_[31u - i];
-		if (a < b) return true;
-		else if (b < a) return false;
-	}
-	return false;
+	return limbs_divmod_1_preinv(nullptr, num.parts_, num.size_,
+		divisor.normalized(), divisor.shift(), divisor.reciprocal());
 }
 
-bool operator>(const uint2048& operand_a, const uint2048& operand_b){
-	return operand_b < operand_a;
+/*
+window width for sliding window exponentiation.
+wider windows need fewer multiplies per exponent bit but a bigger table
+of odd powers (2^(w - 1) entries) to be built up front
+*/
+static uint16_t window_bits(uint16_t exp_bits){
+	if (exp_bits > 671u) return 6u;
+	if (exp_bits > 239u) return 5u;
+	if (exp_bits > 79u) return 4u;
+	if (exp_bits > 23u) return 3u;
+	return 1u;
 }
 
-bool operator<=(const uint2048& operand_a, const uint2048& operand_b){
-	return !(operand_b < operand_a);
+/*
+left to right sliding window exponentiation of a base that is already
+reduced. 'one' is the identity under 'mul', 'sqr'(a) must give the same
+as 'mul'(a, a) and does all of the squarings
+*/
+template <uint16_t Bits, typename Mul, typename Sqr>
+static uint_t<Bits> sliding_window_pow(const uint_t<Bits>& base, const uint_t<Bits>& exp, const uint_t<Bits>& one, Mul mul, Sqr sqr){
+	uint_t<Bits> table[32u];
+	uint_t<Bits> base_squared;
+	uint_t<Bits> ret;
+	uint16_t width, low, index;
+	int high;
+	auto started = false;
+
+	width = window_bits(exp.num_bits());
+
+	// table[i] = base^(2i + 1)
+	table[0] = base;
+	if (width > 1u){
+		base_squared = sqr(base);
+		for (auto i = 1u; i < (1u << (width - 1u)); ++i) table[i] = mul(table[i - 1u], base_squared);
+	}
+
+	ret = one;
+	high = static_cast<int>(exp.num_bits()) - 1;
+	while (high >= 0){
+		if (!exp.test_bit(static_cast<uint16_t>(high))){
+			ret = sqr(ret);
+			--high;
+			continue;
+		}
+
+		// take the longest window of at most 'width' bits that ends in a set bit
+		low = (high + 1 > width) ? static_cast<uint16_t>(high + 1 - width) : 0u;
+		while (!exp.test_bit(low)) ++low;
+
+		index = 0u;
+		for (auto i = high; i >= static_cast<int>(low); --i){
+			index = (index << 1u) | exp.test_bit(static_cast<uint16_t>(i));
+			if (started) ret = sqr(ret);
+		}
+
+		// index is odd, its power is at table[index / 2]
+		if (started) ret = mul(ret, table[index / 2u]);
+		else ret = table[index / 2u];
+		started = true;
+		high = static_cast<int>(low) - 1;
+	}
+	return ret;
 }
 
-bool operator>=(const uint2048& operand_a, const uint2048& operand_b){
-	return !(operand_a < operand_b);
+template <uint16_t Bits>
+uint_t<Bits> pow_mod(const uint_t<Bits>& base, const uint_t<Bits>& exp, const uint_t<Bits>& mod){
+	if (mod == 0ull) throw std::domain_error("uint_t: division by zero");
+	if (mod & 1ull) return pow_mod(base, exp, MontgomeryContext<Bits>{ mod });
+	return pow_mod(base, exp, BarrettContext<Bits>{ mod });
 }
 
+template <uint16_t Bits>
+uint_t<Bits> pow_mod(const uint_t<Bits>& base, const uint_t<Bits>& exp, const MontgomeryContext<Bits>& ctx){
+	BIGNUM_INSTRUMENT_SCOPE(pow_mod, base.num_limbs() + exp.num_limbs() + ctx.modulus().num_limbs());
 
-// --- static functions ---
+	uint_t<Bits> ret;
+
+	auto mul = [&](const uint_t<Bits>& a, const uint_t<Bits>& b){
+		return ctx.mont_mul(a, b);
+	};
+	auto sqr = [&](const uint_t<Bits>& a){
+		return ctx.mont_sqr(a);
+	};
+
+	ret = sliding_window_pow(ctx.to_mont(base % ctx.modulus()), exp, ctx.one(), mul, sqr);
+	return ctx.from_mont(ret);
+}
+
+template <uint16_t Bits>
+uint_t<Bits> pow_mod(const uint_t<Bits>& base, const uint_t<Bits>& exp, const BarrettContext<Bits>& ctx){
+	BIGNUM_INSTRUMENT_SCOPE(pow_mod, base.num_limbs() + exp.num_limbs() + ctx.modulus().num_limbs());
 
-uint2048 gcd_mod(const uint2048& a, const uint2048& b){
-	uint2048 temp_a, temp_b;
-	uint2048 temp_t;
+	auto mul = [&](const uint_t<Bits>& a, const uint_t<Bits>& b){
+		return ctx.mul_mod(a, b);
+	};
+	auto sqr = [&](const uint_t<Bits>& a){
+		return ctx.sqr_mod(a);
+	};
+
+	return sliding_window_pow(ctx.reduce(base), exp, ctx.reduce(uint_t<Bits>{ 1ull }), mul, sqr);
+}
+
+template <uint16_t Bits>
+uint_t<Bits> gcd_mod(const uint_t<Bits>& a, const uint_t<Bits>& b){
+	BIGNUM_INSTRUMENT_SCOPE(gcd, a.num_limbs() + b.num_limbs());
+
+	uint_t<Bits> temp_a, temp_b;
+	uint_t<Bits> temp_t;
 
 	temp_a = a;
 	temp_b = b;
@@ -644,8 +1423,15 @@ uint2048 gcd_mod(const uint2048& a, const uint2048& b){
 	return temp_a;
 }
 
-uint2048 gcd_sub(const uint2048& a, const uint2048& b){
-	uint2048 temp_a, temp_b;
+template <uint16_t Bits>
+uint_t<Bits> gcd_sub(const uint_t<Bits>& a, const uint_t<Bits>& b){
+	BIGNUM_INSTRUMENT_SCOPE(gcd, a.num_limbs() + b.num_limbs());
+
+	uint_t<Bits> temp_a, temp_b;
+
+	// gcd(a, 0) = a, subtracting 0 would never get anywhere
+	if (a == 0ull) return b;
+	if (b == 0ull) return a;
 
 	temp_a = a;
 	temp_b = b;
@@ -656,3 +1442,416 @@ uint2048 gcd_sub(const uint2048& a, const uint2048& b){
 	return temp_a;
 }
 
+template <uint16_t Bits>
+uint_t<Bits> gcd_binary(const uint_t<Bits>& a, const uint_t<Bits>& b){
+	BIGNUM_INSTRUMENT_SCOPE(gcd, a.num_limbs() + b.num_limbs());
+
+	uint_t<Bits> temp_a, temp_b;
+	uint_t<Bits> *u, *v, *t;
+	uint16_t zeros_a, zeros_b;
+
+	if (a == 0ull) return b;
+	if (b == 0ull) return a;
+
+	zeros_a = a.trailing_zeros();
+	zeros_b = b.trailing_zeros();
+	temp_a = a >> zeros_a;
+	temp_b = b >> zeros_b;
+
+	// both odd from here on, so their difference is even
+	u = &temp_a;
+	v = &temp_b;
+	for (;;){
+		if (*u > *v){
+			t = u;
+			u = v;
+			v = t;
+		}
+		*v -= *u;
+		if (*v == 0ull) break;
+		*v >>= v->trailing_zeros();
+	}
+
+	// the factors of 2 both had in common
+	return *u << ((zeros_a < zeros_b) ? zeros_a : zeros_b);
+}
+
+/*
+runs euclid's algorithm on the leading bits x_hat >= y_hat of two numbers
+for as long as every quotient is certain to match the one the full numbers
+would give. all the values stay below 2^62 in magnitude.
+matrix gets the magnitudes of the cofactors a, b, c, d such that the full
+numbers after the steps are (a * x + b * y, c * x + d * y).
+a and d are >= 0 and b and c <= 0 after an even number of steps,
+the other way around after an odd number.
+returns the number of steps
+*/
+static uint32_t lehmer_steps(int64_t x_hat, int64_t y_hat, uint64_t* matrix){
+	int64_t a, b, c, d;
+	int64_t q, t;
+	uint32_t steps = 0u;
+
+	a = 1;
+	b = 0;
+	c = 0;
+	d = 1;
+	while (y_hat + c != 0 && y_hat + d != 0){
+		q = (x_hat + a) / (y_hat + c);
+		if (q != (x_hat + b) / (y_hat + d)) break;
+
+		t = a - q * c;
+		a = c;
+		c = t;
+		t = b - q * d;
+		b = d;
+		d = t;
+		t = x_hat - q * y_hat;
+		x_hat = y_hat;
+		y_hat = t;
+		++steps;
+	}
+
+	matrix[0] = static_cast<uint64_t>(a < 0 ? -a : a);
+	matrix[1] = static_cast<uint64_t>(b < 0 ? -b : b);
+	matrix[2] = static_cast<uint64_t>(c < 0 ? -c : c);
+	matrix[3] = static_cast<uint64_t>(d < 0 ? -d : d);
+	return steps;
+}
+
+/*
+lehmer's algorithm shared by gcd_lehmer and ext_gcd.
+remainder i of euclid's algorithm is r_i = (-1)^i * (s_i * a - t_i * b),
+s and t get the magnitudes s_k and t_k for the last non-zero remainder and
+odd is set if k is odd. s and t may be nullptr if only the gcd is wanted.
+*/
+template <uint16_t Bits>
+static uint_t<Bits> lehmer(const uint_t<Bits>& a, const uint_t<Bits>& b, uint_t<Bits>* s, uint_t<Bits>* t, bool* odd){
+	uint_t<Bits> x, y, q, r;
+	uint_t<Bits> s_x, s_y, t_x, t_y, temp;
+	uint64_t matrix[4];
+	uint32_t steps;
+	uint16_t shift;
+	bool cofactors;
+
+	cofactors = s && t;
+	x = a;
+	y = b;
+	s_x = 1ull;
+	t_y = 1ull;
+	*odd = false;
+
+	while (y != 0ull){
+		steps = 0u;
+
+		// the leading bits are only worth it while y is more than one limb,
+		// and need x >= y to line up
+		if (y.num_limbs() > 1u && x >= y){
+			shift = x.num_bits() - 62u;
+			steps = lehmer_steps(static_cast<int64_t>(x.bits_at(shift)), static_cast<int64_t>(y.bits_at(shift)), matrix);
+		}
+
+		if (!steps){
+			// one plain euclid step, the quotient can be as big as it likes
+			divmod(x, y, &q, &r);
+			x = y;
+			y = r;
+			if (cofactors){
+				temp = s_x + q * s_y;
+				s_x = s_y;
+				s_y = temp;
+				temp = t_x + q * t_y;
+				t_x = t_y;
+				t_y = temp;
+			}
+			*odd = !*odd;
+			continue;
+		}
+
+		/*
+		the new remainders are both smaller than x, so any wrap around
+		2^Bits in the products cancels out in the difference
+		*/
+		if (steps & 1u){
+			temp = y * matrix[1] - x * matrix[0];
+			y = x * matrix[2] - y * matrix[3];
+		}
+		else{
+			temp = x * matrix[0] - y * matrix[1];
+			y = y * matrix[3] - x * matrix[2];
+		}
+		x = temp;
+
+		// the cofactor magnitudes only ever add up
+		if (cofactors){
+			temp = s_x * matrix[0] + s_y * matrix[1];
+			s_y = s_x * matrix[2] + s_y * matrix[3];
+			s_x = temp;
+			temp = t_x * matrix[0] + t_y * matrix[1];
+			t_y = t_x * matrix[2] + t_y * matrix[3];
+			t_x = temp;
+		}
+		if (steps & 1u) *odd = !*odd;
+	}
+
+	if (cofactors){
+		*s = s_x;
+		*t = t_x;
+	}
+	return x;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> gcd_lehmer(const uint_t<Bits>& a, const uint_t<Bits>& b){
+	BIGNUM_INSTRUMENT_SCOPE(gcd, a.num_limbs() + b.num_limbs());
+
+	bool odd;
+
+	return lehmer<Bits>(a, b, nullptr, nullptr, &odd);
+}
+
+template <uint16_t Bits>
+uint_t<Bits> ext_gcd(const uint_t<Bits>& a, const uint_t<Bits>& b,
+	typename non_deduced<uint_t<Bits>>::type* x, typename non_deduced<uint_t<Bits>>::type* y){
+	BIGNUM_INSTRUMENT_SCOPE(gcd, a.num_limbs() + b.num_limbs());
+
+	uint_t<Bits> g, s, t;
+	bool odd;
+
+	if (a == 0ull){
+		if (x) *x = 0ull;
+		if (y) *y = 0ull;
+		return b;
+	}
+
+	g = lehmer(a, b, &s, &t, &odd);
+
+	// g = t * b - s * a, move it to the other sign with the solution that
+	// is one period of (b / g, a / g) away
+	if (odd){
+		s = b / g - s;
+		t = a / g - t;
+	}
+	if (x) *x = s;
+	if (y) *y = t;
+	return g;
+}
+
+template <uint16_t Bits>
+bool mod_inverse(const uint_t<Bits>& a, const uint_t<Bits>& m, typename non_deduced<uint_t<Bits>>::type* inverse){
+	uint_t<Bits> g, x;
+
+	if (m == 0ull) return false;
+	if (m == 1ull){
+		*inverse = 0ull;
+		return true;
+	}
+
+	// a * x - m * y = 1 means a * x = 1 mod m
+	g = ext_gcd(a % m, m, &x, nullptr);
+	if (g != 1ull) return false;
+
+	*inverse = x % m;
+	return true;
+}
+
+template <uint16_t Bits>
+uint_t<Bits> isqrt(const uint_t<Bits>& num){
+	uint_t<Bits> x, y;
+
+	if (num == 0ull) return num;
+
+	// 2^ceil(bits / 2) is above the root
+	x = uint_t<Bits>{ 1ull } << static_cast<uint16_t>((num.num_bits() + 1u) / 2u);
+	for (;;){
+		y = (x + num / x) >> 1u;
+		if (!(y < x)) return x;
+		x = y;
+	}
+}
+
+// 63 * 65 * 11, one pass over num gives the residues mod all three
+#define SQUARE_MODULI_PRODUCT 45045ull
+
+/*
+returns the squares mod 64, 63, 65 and 11 in that order, entry r of a
+table is true if r is a square mod its modulus. built on the first call
+*/
+static const std::vector<std::vector<bool>>& square_residues(){
+	static const std::vector<std::vector<bool>> residues = []{
+		std::vector<std::vector<bool>> ret;
+
+		for (auto m : { 64u, 63u, 65u, 11u }){
+			std::vector<bool> squares(m, false);
+
+			for (auto i = 0u; i < m; ++i) squares[(i * i) % m] = true;
+			ret.push_back(std::move(squares));
+		}
+		return ret;
+	}();
+	return residues;
+}
+
+template <uint16_t Bits>
+bool is_square(const uint_t<Bits>& num){
+	uint_t<Bits> root;
+	uint64_t rem;
+	const auto& squares = square_residues();
+
+	// the low limb gives num mod 64 for free
+	if (!squares[0][num & 63ull]) return false;
+
+	rem = mod_u64(num, SQUARE_MODULI_PRODUCT);
+	if (!squares[1][rem % 63u] || !squares[2][rem % 65u] || !squares[3][rem % 11u]) return false;
+
+	root = isqrt(num);
+	return root * root == num;
+}
+
+/*
+(a / n) for n odd and both in one limb
+*/
+static int jacobi_u64(uint64_t a, uint64_t n){
+	unsigned long zeros;
+	auto ret = 1;
+
+	a %= n;
+	while (a){
+		// (2 / n) = -1 when n = 3 or 5 mod 8
+		_BitScanForward64(&zeros, a);
+		a >>= zeros;
+		if ((zeros & 1ul) && ((n & 7ull) == 3ull || (n & 7ull) == 5ull)) ret = -ret;
+
+		// reciprocity, (a / n) = -(n / a) when both are 3 mod 4
+		if ((a & 3ull) == 3ull && (n & 3ull) == 3ull) ret = -ret;
+		std::swap(a, n);
+		a %= n;
+	}
+	return (n == 1ull) ? ret : 0;
+}
+
+template <uint16_t Bits>
+int jacobi(const uint_t<Bits>& a, const uint_t<Bits>& n){
+	uint_t<Bits> temp_a, temp_n;
+	uint16_t zeros;
+	auto ret = 1;
+
+	if (!(n & 1ull)) throw std::invalid_argument("jacobi: n must be odd");
+
+	temp_a = a % n;
+	temp_n = n;
+	while (temp_n.num_limbs() > 1u){
+		if (temp_a == 0ull) return 0;
+
+		zeros = temp_a.trailing_zeros();
+		temp_a >>= zeros;
+		if ((zeros & 1u) && ((temp_n & 7ull) == 3ull || (temp_n & 7ull) == 5ull)) ret = -ret;
+
+		if ((temp_a & 3ull) == 3ull && (temp_n & 3ull) == 3ull) ret = -ret;
+		std::swap(temp_a, temp_n);
+		temp_a %= temp_n;
+	}
+	return ret * jacobi_u64(temp_a & ~0ull, temp_n & ~0ull);
+}
+
+template <uint16_t Bits>
+int jacobi(int64_t a, const uint_t<Bits>& n){
+	uint64_t magnitude;
+	unsigned long zeros;
+	auto ret = 1;
+
+	if (!(n & 1ull)) throw std::invalid_argument("jacobi: n must be odd");
+
+	// (-1 / n) = -1 when n = 3 mod 4
+	magnitude = (a < 0) ? 0ull - static_cast<uint64_t>(a) : static_cast<uint64_t>(a);
+	if (a < 0 && (n & 3ull) == 3ull) ret = -ret;
+
+	if (!magnitude) return (n == 1ull) ? ret : 0;
+	_BitScanForward64(&zeros, magnitude);
+	magnitude >>= zeros;
+	if ((zeros & 1ul) && ((n & 7ull) == 3ull || (n & 7ull) == 5ull)) ret = -ret;
+
+	// one swap and the rest fits in a limb
+	if ((magnitude & 3ull) == 3ull && (n & 3ull) == 3ull) ret = -ret;
+	return ret * jacobi_u64(mod_u64(n, magnitude), magnitude);
+}
+
+// --- instantiations ---
+
+#define UINT_T_INSTANTIATE(BITS) \
+	template class uint_t<BITS>; \
+	template uint_t<BITS>& operator+=(uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS>& operator+=(uint_t<BITS>&, uint64_t); \
+	template uint_t<BITS>& operator-=(uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS>& operator*=(uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS>& operator*=(uint_t<BITS>&, uint64_t); \
+	template uint_t<BITS>& operator/=(uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS>& operator/=(uint_t<BITS>&, uint64_t); \
+	template uint_t<BITS>& operator/=(uint_t<BITS>&, const U64Divisor&); \
+	template uint_t<BITS>& operator%=(uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS>& operator&=(uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS>& operator|=(uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS>& operator^=(uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS>& operator<<=(uint_t<BITS>&, uint16_t); \
+	template uint_t<BITS>& operator>>=(uint_t<BITS>&, uint16_t); \
+	template uint_t<BITS> operator+(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> operator+(const uint_t<BITS>&, uint64_t); \
+	template uint_t<BITS> operator+(uint64_t, const uint_t<BITS>&); \
+	template uint_t<BITS> operator-(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> operator-(const uint_t<BITS>&, uint64_t); \
+	template uint_t<BITS> operator*(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> operator*(const uint_t<BITS>&, uint64_t); \
+	template uint_t<BITS> operator*(uint64_t, const uint_t<BITS>&); \
+	template uint_t<BITS> operator/(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> operator/(const uint_t<BITS>&, uint64_t); \
+	template uint_t<BITS> operator/(const uint_t<BITS>&, const U64Divisor&); \
+	template uint_t<BITS> operator%(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> operator&(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint64_t operator&(const uint_t<BITS>&, uint64_t); \
+	template uint_t<BITS> operator|(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> operator^(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> operator~(const uint_t<BITS>&); \
+	template uint_t<BITS> operator<<(const uint_t<BITS>&, uint16_t); \
+	template uint_t<BITS> operator>>(const uint_t<BITS>&, uint16_t); \
+	template bool operator==(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template bool operator==(const uint_t<BITS>&, uint64_t); \
+	template bool operator!=(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template bool operator!=(const uint_t<BITS>&, uint64_t); \
+	template bool operator<(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template bool operator<(const uint_t<BITS>&, uint64_t); \
+	template bool operator>(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template bool operator>(const uint_t<BITS>&, uint64_t); \
+	template bool operator<=(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template bool operator<=(const uint_t<BITS>&, uint64_t); \
+	template bool operator>=(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template bool operator>=(const uint_t<BITS>&, uint64_t); \
+	template void mul(const uint_t<BITS>&, const uint_t<BITS>&, uint_t<BITS>*); \
+	template void sqr(const uint_t<BITS>&, uint_t<BITS>*); \
+	template void mul_add(const uint_t<BITS>&, const uint_t<BITS>&, const uint_t<BITS>&, uint_t<BITS>*); \
+	template bool divmod(const uint_t<BITS>&, const uint_t<BITS>&, uint_t<BITS>*, uint_t<BITS>*); \
+	template bool mul_mod(const uint_t<BITS>&, const uint_t<BITS>&, const uint_t<BITS>&, uint_t<BITS>*); \
+	template bool add_mod(const uint_t<BITS>&, const uint_t<BITS>&, const uint_t<BITS>&, uint_t<BITS>*); \
+	template bool sub_mod(const uint_t<BITS>&, const uint_t<BITS>&, const uint_t<BITS>&, uint_t<BITS>*); \
+	template bool sqr_mod(const uint_t<BITS>&, const uint_t<BITS>&, uint_t<BITS>*); \
+	template uint64_t mod_u64(const uint_t<BITS>&, uint64_t); \
+	template uint64_t mod_u64(const uint_t<BITS>&, const U64Divisor&); \
+	template uint_t<BITS> pow_mod(const uint_t<BITS>&, const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> pow_mod(const uint_t<BITS>&, const uint_t<BITS>&, const MontgomeryContext<BITS>&); \
+	template uint_t<BITS> pow_mod(const uint_t<BITS>&, const uint_t<BITS>&, const BarrettContext<BITS>&); \
+	template uint_t<BITS> gcd_mod(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> gcd_sub(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> gcd_binary(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> gcd_lehmer(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template uint_t<BITS> ext_gcd(const uint_t<BITS>&, const uint_t<BITS>&, uint_t<BITS>*, uint_t<BITS>*); \
+	template bool mod_inverse(const uint_t<BITS>&, const uint_t<BITS>&, uint_t<BITS>*); \
+	template uint_t<BITS> isqrt(const uint_t<BITS>&); \
+	template bool is_square(const uint_t<BITS>&); \
+	template int jacobi(const uint_t<BITS>&, const uint_t<BITS>&); \
+	template int jacobi(int64_t, const uint_t<BITS>&);
+
+UINT_T_INSTANTIATE(256u)
+UINT_T_INSTANTIATE(512u)
+UINT_T_INSTANTIATE(1024u)
+UINT_T_INSTANTIATE(1536u)
+UINT_T_INSTANTIATE(2048u)
+UINT_T_INSTANTIATE(3072u)
+UINT_T_INSTANTIATE(4096u)
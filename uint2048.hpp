@@ -4,20 +4,145 @@
 #include <bitset>
 #include <chrono> // for random numbers
 #include <cstdint>
-#include <intrin.h>
 #include <iostream>
 #include <random> // for random numbers
+#include <string>
+#include <type_traits>
 #include <utility>
 
+#include "intrinsics.hpp"
+
+template <uint16_t Bits> class BarrettContext;
+template <uint16_t Bits> class MontgomeryContext;
+template <uint16_t Bits> class RecordFile;
+
+/*
+keeps a parameter out of template argument deduction,
+so nullptr can be passed for optional output pointers
+*/
+template <typename T> struct non_deduced{ using type = T; };
+
+/*
+U64Divisor
+
+a single limb divisor with its reciprocal computed up front.
+dividing a uint_t by it costs a couple of multiplies per limb instead of a
+div instruction, so build one when the same divisor is used many times.
+throws std::domain_error if divisor is zero.
+*/
+class U64Divisor{
+private:
+	uint64_t divisor_;
+	uint64_t normalized_;  // divisor_ << shift_, top bit set
+	uint64_t reciprocal_;  // limbs_reciprocal_1(normalized_)
+	uint8_t shift_;
+
+public:
+	explicit U64Divisor(uint64_t divisor);
+
+	uint64_t divisor() const{ return divisor_; }
+	uint64_t normalized() const{ return normalized_; }
+	uint64_t reciprocal() const{ return reciprocal_; }
+	uint8_t shift() const{ return shift_; }
+};
+
+/*
+byte order of the byte arrays uint_t::to_bytes and uint_t::from_bytes use.
+big puts the most significant byte first, as in most file formats and on
+the wire, little the least significant one first
+*/
+enum class ByteOrder{ big, little };
 
 /*
 
 TODO: Vectorize all the things!
 
 */
-class uint2048{
+
+/*
+uint_t
+
+fixed width unsigned integer of 'Bits' bits, stored as Bits / 64 limbs.
+the limb count is a compile time constant, so every width gets its own code.
+widths of up to LIMBS_FIXED_MAX limbs (limb_ops.hpp, 512 bits by default)
+add, subtract, take truncated products and do add_mod / sub_mod with
+kernels unrolled for their exact limb count. the other operations, and
+every operation on wider numbers, go through the runtime length kernels
+and only touch the limbs in use.
+
+uint_t is explicitly instantiated in uint2048.cpp for the widths that have
+an alias below. add a line to the list there to use another width.
+*/
+template <uint16_t Bits>
+class uint_t{
+	static_assert(Bits > 0u && Bits % 64u == 0u, "uint_t: Bits must be a multiple of 64");
+
+public:
+	static constexpr uint16_t Limbs = Bits / 64u;
+
 private:
-	uint64_t parts_[32u];
+	uint64_t parts_[Limbs];
+
+	/*
+	number of limbs in use.
+	parts_[size_ - 1] is the most significant non-zero limb and every limb
+	from size_ up is zero. 0 for the number 0.
+	every operator keeps this up to date so loops only touch live limbs
+	*/
+	uint16_t size_;
+
+	/*
+	sets size_ after parts_ was written to directly.
+	'size' is an upper bound, every limb at or above it must already be zero
+	*/
+	void trim(uint16_t size);
+
+	/*
+	copies limbs[0..size) into parts_ and zeroes the limbs above them that
+	were in use before, then trims. limbs must not point into parts_
+	*/
+	void set_limbs(const uint64_t* limbs, uint16_t size);
+
+	/*
+	returns 64 random bits, from two calls for 32 bit generators
+	*/
+	template <typename URBG>
+	static uint64_t random_limb(URBG* gen){
+		static_assert(URBG::min() == 0u && (URBG::max() == ~0ull || URBG::max() == 0xffffffffull),
+			"uint_t: the generator has to give 32 or 64 random bits per call");
+
+		if constexpr (URBG::max() == 0xffffffffull){
+			uint64_t high = (*gen)();
+
+			return (high << 32u) | static_cast<uint64_t>((*gen)());
+		}
+		else return static_cast<uint64_t>((*gen)());
+	}
+
+	/*
+	sets the number to 'num_bits' random bits, with the top one set if
+	'top_bit' is. a partial top limb takes the high bits of its draw.
+	only the limbs that were in use are cleared, not the whole array
+	*/
+	template <typename URBG>
+	void assign_random(uint16_t num_bits, bool top_bit, URBG* gen){
+		uint16_t size, overflow;
+
+		overflow = num_bits % 64u;
+		size = num_bits / 64u;
+
+		for (auto i = 0u; i < size; ++i) parts_[i] = random_limb(gen);
+		if (overflow) parts_[size++] = random_limb(gen) >> (64u - overflow);
+		if (top_bit && num_bits) parts_[(num_bits - 1u) / 64u] |= 1ull << ((num_bits - 1u) % 64u);
+
+		for (auto i = size; i < size_; ++i) parts_[i] = 0ull;
+		trim(size);
+	}
+
+	template <uint16_t> friend class uint_t;
+	template <uint16_t> friend class BarrettContext;
+	template <uint16_t> friend class MontgomeryContext;
+	template <uint16_t> friend class RecordFile;
 
 public:
 
@@ -28,23 +153,43 @@ public:
 	default constructor
 	sets all unsigned long longs to zero
 	*/
-	uint2048();
+	uint_t();
 
 	/*
 	sets all but the least significant unsigned long long to zero.
 	the least significant is set to the 'num' argument
 	*/
-	uint2048(uint64_t num);
+	uint_t(uint64_t num);
 
-	// - copy -
+	// - copy / move -
 
 	/*
-	copys the array from the input uint2048 into a new one
+	defaulted, so uint_t stays trivially copyable and copies are a plain
+	memcpy the compiler can see through
 	*/
-	uint2048(const uint2048& num);
+	uint_t(const uint_t& num) = default;
+	uint_t(uint_t&& num) = default;
+	uint_t& operator=(const uint_t& num) = default;
+	uint_t& operator=(uint_t&& num) = default;
+
+	// - conversion -
+
+	/*
+	converts from another width.
+	widening zero extends, narrowing keeps the low Bits bits
+	*/
+	template <uint16_t OtherBits>
+	explicit uint_t(const uint_t<OtherBits>& num){
+		uint16_t size;
+
+		size = (num.size_ < Limbs) ? num.size_ : Limbs;
+		for (auto i = 0u; i < size; ++i) parts_[i] = num.parts_[i];
+		for (auto i = size; i < Limbs; ++i) parts_[i] = 0ull;
+		trim(size);
+	}
 
 	// --- destructor ---
-	~uint2048(){}
+	~uint_t() = default;
 
 	// --- functions ---
 
@@ -60,122 +205,448 @@ public:
 	*/
 	uint16_t num_bits() const;
 
-	std::bitset<2048> to_bitset();
+	/*
+	returns the number of 64 bit limbs the current number takes up
+	*/
+	uint16_t num_limbs() const{ return size_; }
 
 	/*
-	generates a uint2048 with a given bit length
+	returns true if the bit at 'index' is set.
+	index 0 is the least significant bit
 	*/
-	static uint2048 Random(uint16_t num_bits, std::mt19937_64* mt_rand){
-		uint2048 ret;
-		uint8_t num_loops;
-		uint8_t overflow;
+	bool test_bit(uint16_t index) const;
 
-		overflow = num_bits % 64u;
-		num_loops = num_bits / 64u;
-
-		for (auto i = 0u; i < num_loops; ++i)
-			ret.parts_[i] = (*mt_rand)();
-
-		if (overflow){
-			auto r = (*mt_rand)();
-			
-			r >>= 64u - overflow;
-			if (r >> (overflow - 1u) != 1u){
-				auto to_add = 1ull;
-				
-				to_add <<= overflow - 1u;
-				r += to_add;
-			}
-			ret.parts_[num_loops] = r;
-		}
+	/*
+	returns the 64 bits starting at bit 'index', bits past the top read as 0
+	*/
+	uint64_t bits_at(uint16_t index) const;
+
+	/*
+	returns the number of zero bits below the least significant set bit.
+	Bits for the number 0
+	*/
+	uint16_t trailing_zeros() const;
+
+	std::bitset<Bits> to_bitset() const;
+
+	/*
+	writes the number to the 'length' bytes at out, zero padded at the top.
+	a limb at a time, byte swapped for big endian (x86-64 is little endian).
+	returns false and leaves out untouched if the number does not fit
+	*/
+	bool to_bytes(uint8_t* out, size_t length, ByteOrder order = ByteOrder::big) const;
+
+	/*
+	reads a number from the 'length' bytes at bytes, the opposite of to_bytes.
+	throws std::out_of_range if the number does not fit in Bits bits,
+	leading zero bytes past the top are fine
+	*/
+	static uint_t from_bytes(const uint8_t* bytes, size_t length, ByteOrder order = ByteOrder::big);
+
+	/*
+	returns the number written out in 'base', which is 2, 8, 10 or 16.
+	no prefix and no leading zeros, hex digits are lower case, "0" for 0.
+	powers of 2 are a walk over the bits. decimal splits the number in two
+	around a cached power of 10^19 and converts both halves on their own,
+	19 digits per single limb division at the bottom.
+	throws std::invalid_argument for another base
+	*/
+	std::string to_string(uint8_t base = 10u) const;
+
+	/*
+	parses 'str' as a number in 'base' (2, 8, 10 or 16), no prefix or sign.
+	hex digits may be upper or lower case, leading zeros are skipped.
+	decimal joins the halves of the string with one multiply by a power
+	of 10^19, the other direction of to_string.
+	throws std::invalid_argument for another base, an empty string or a
+	character that is not a digit, std::out_of_range if the number does
+	not fit in Bits bits
+	*/
+	static uint_t from_string(const std::string& str, uint8_t base = 10u);
+
+	/*
+	generates a uint_t of exactly 'num_bits' bits, the top one is always set.
+	gen can be any UniformRandomBitGenerator with 32 or 64 bit outputs,
+	Xoshiro256 from random.hpp is the fast one
+	*/
+	template <typename URBG>
+	static uint_t Random(uint16_t num_bits, URBG* gen){
+		uint_t ret;
+
+		ret.assign_random(num_bits, true, gen);
 		return ret;
 	}
 
 	/*
-	generates a uint2048 within given bounds
+	generates a uint_t in [min, max], every value equally likely.
+	rejection sampling: draws as many bits as max - min has and draws
+	again while the draw is above it, which is less than 2 draws on average
 	*/
-	static uint2048 Random(const uint2048& min, const uint2048& max, std::mt19937_64* mt_rand){
-		uint2048 ret;
-		uint16_t max_bits;
+	template <typename URBG>
+	static uint_t Random(const uint_t& min, const uint_t& max, URBG* gen){
+		uint_t range, ret;
+		uint16_t bits;
+
+		range = max - min;
+		bits = range.num_bits();
+		do ret.assign_random(bits, false, gen);
+		while (ret > range);
 
-		max_bits = max.num_bits();
-		ret = Random(max_bits, mt_rand);
-		ret %= (max - min + 1ull);
 		ret += min;
 		return ret;
 	}
 
+	template <uint16_t B, typename URBG> friend void fill_random(uint_t<B>* nums, size_t count, uint16_t num_bits, URBG* gen);
+
 	// --- operators ---
 
 	// - assignment -
 
-	friend uint2048& operator+=(uint2048& operand_a, const uint2048& operand_b);
-	friend uint2048& operator+=(uint2048& operand_a, uint64_t operand_b);
+	template <uint16_t B> friend uint_t<B>& operator+=(uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend uint_t<B>& operator+=(uint_t<B>& operand_a, uint64_t operand_b);
+
+	template <uint16_t B> friend uint_t<B>& operator-=(uint_t<B>& operand_a, const uint_t<B>& operand_b);
+
+	template <uint16_t B> friend uint_t<B>& operator*=(uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend uint_t<B>& operator*=(uint_t<B>& operand_a, uint64_t operand_b);
 
-	friend uint2048& operator-=(uint2048& operand_a, const uint2048& operand_b);
+	// throws std::domain_error when dividing by zero
+	template <uint16_t B> friend uint_t<B>& operator/=(uint_t<B>& operand_dividend, const uint_t<B>& operand_divisor);
+	template <uint16_t B> friend uint_t<B>& operator/=(uint_t<B>& operand_dividend, uint64_t operand_divisor);
+	template <uint16_t B> friend uint_t<B>& operator/=(uint_t<B>& operand_dividend, const U64Divisor& operand_divisor);
 
-	friend uint2048& operator%=(uint2048& operand_dividend, const uint2048& operand_divisor);
+	// throws std::domain_error when dividing by zero
+	template <uint16_t B> friend uint_t<B>& operator%=(uint_t<B>& operand_dividend, const uint_t<B>& operand_divisor);
 
-	friend uint2048& operator<<=(uint2048& operand_a, uint16_t operand_b);
-	friend uint2048& operator>>=(uint2048& operand_a, uint16_t operand_b);
+	template <uint16_t B> friend uint_t<B>& operator&=(uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend uint_t<B>& operator|=(uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend uint_t<B>& operator^=(uint_t<B>& operand_a, const uint_t<B>& operand_b);
+
+	template <uint16_t B> friend uint_t<B>& operator<<=(uint_t<B>& operand_a, uint16_t operand_b);
+	template <uint16_t B> friend uint_t<B>& operator>>=(uint_t<B>& operand_a, uint16_t operand_b);
 
 	// - increment/decrement -
-	
-	uint2048& operator++();
-	uint2048 operator++(int);
+
+	uint_t& operator++();
+	uint_t operator++(int);
 
 	// - arithmetic -
 
-	friend uint2048 operator+(const uint2048& operand_a, const uint2048& operand_b);
-	friend uint2048 operator+(const uint2048& operand_a, uint64_t operand_b);
-	friend uint2048 operator+(uint64_t operand_a, const uint2048& operand_b);
+	template <uint16_t B> friend uint_t<B> operator+(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend uint_t<B> operator+(const uint_t<B>& operand_a, uint64_t operand_b);
+	template <uint16_t B> friend uint_t<B> operator+(uint64_t operand_a, const uint_t<B>& operand_b);
+
+	template <uint16_t B> friend uint_t<B> operator-(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend uint_t<B> operator-(const uint_t<B>& operand_a, uint64_t operand_b);
 
-	friend uint2048 operator-(const uint2048& operand_a, const uint2048& operand_b);
-	friend uint2048 operator-(const uint2048& operand_a, uint64_t operand_b);
+	template <uint16_t B> friend uint_t<B> operator*(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend uint_t<B> operator*(const uint_t<B>& operand_a, uint64_t operand_b);
+	template <uint16_t B> friend uint_t<B> operator*(uint64_t operand_a, const uint_t<B>& operand_b);
 
-	friend uint2048 operator*(const uint2048& operand_a, const uint2048& operand_b);
+	// / and % throw std::domain_error when dividing by zero
+	template <uint16_t B> friend uint_t<B> operator/(const uint_t<B>& dividend, const uint_t<B>& divisor);
+	template <uint16_t B> friend uint_t<B> operator/(const uint_t<B>& dividend, uint64_t divisor);
+	template <uint16_t B> friend uint_t<B> operator/(const uint_t<B>& dividend, const U64Divisor& divisor);
 
-	friend uint2048 operator/(const uint2048& dividend, const uint2048& divisor);
+	template <uint16_t B> friend uint_t<B> operator%(const uint_t<B>& operand_dividend, const uint_t<B>& operand_divisor);
 
-	friend uint2048 operator%(const uint2048& operand_dividend, const uint2048& operand_divisor);
+	template <uint16_t B> friend uint_t<B> operator&(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend uint64_t operator&(const uint_t<B>& operand_a, uint64_t operand_b);
 
-	friend uint2048 operator&(const uint2048& operand_a, const uint2048& operand_b);
-	friend uint64_t operator&(const uint2048& operand_a, uint64_t operand_b);
-	
-	friend uint2048 operator<<(const uint2048& operand_a, uint16_t operand_b);
-	friend uint2048 operator>>(const uint2048& operand_a, uint16_t operand_b);
+	template <uint16_t B> friend uint_t<B> operator|(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend uint_t<B> operator^(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+
+	// ~ flips all Bits bits, not just the ones up to the highest set bit
+	template <uint16_t B> friend uint_t<B> operator~(const uint_t<B>& operand_a);
+
+	template <uint16_t B> friend uint_t<B> operator<<(const uint_t<B>& operand_a, uint16_t operand_b);
+	template <uint16_t B> friend uint_t<B> operator>>(const uint_t<B>& operand_a, uint16_t operand_b);
 
 	// - comparison
 
-	friend bool operator==(const uint2048& operand_a, const uint2048& operand_b);
-	friend bool operator==(const uint2048& operand_a, uint64_t operand_b);
-	
-	friend bool operator!=(const uint2048& operand_a, const uint2048& operand_b);
+	template <uint16_t B> friend bool operator==(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend bool operator==(const uint_t<B>& operand_a, uint64_t operand_b);
+
+	template <uint16_t B> friend bool operator!=(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend bool operator!=(const uint_t<B>& operand_a, uint64_t operand_b);
 
-	friend bool operator<(const uint2048& operand_a, const uint2048& operand_b);
+	template <uint16_t B> friend bool operator<(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend bool operator<(const uint_t<B>& operand_a, uint64_t operand_b);
 
-	friend bool operator>(const uint2048& operand_a, const uint2048& operand_b);
+	template <uint16_t B> friend bool operator>(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend bool operator>(const uint_t<B>& operand_a, uint64_t operand_b);
 
-	friend bool operator<=(const uint2048& operand_a, const uint2048& operand_b);
+	template <uint16_t B> friend bool operator<=(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend bool operator<=(const uint_t<B>& operand_a, uint64_t operand_b);
 
-	friend bool operator>=(const uint2048& operand_a, const uint2048& operand_b);
+	template <uint16_t B> friend bool operator>=(const uint_t<B>& operand_a, const uint_t<B>& operand_b);
+	template <uint16_t B> friend bool operator>=(const uint_t<B>& operand_a, uint64_t operand_b);
+
+	// --- static functions ---
+
+	template <uint16_t B> friend void mul(const uint_t<B>& a, const uint_t<B>& b, typename non_deduced<uint_t<B>>::type* result);
+	template <uint16_t B> friend void sqr(const uint_t<B>& a, typename non_deduced<uint_t<B>>::type* result);
+	template <uint16_t B> friend void mul_add(const uint_t<B>& a, const uint_t<B>& b, const uint_t<B>& c,
+		typename non_deduced<uint_t<B>>::type* result);
+	template <uint16_t B> friend bool divmod(const uint_t<B>& dividend, const uint_t<B>& divisor,
+		typename non_deduced<uint_t<B>>::type* quotient, typename non_deduced<uint_t<B>>::type* remainder);
+	template <uint16_t B> friend uint64_t mod_u64(const uint_t<B>& num, uint64_t divisor);
+	template <uint16_t B> friend uint64_t mod_u64(const uint_t<B>& num, const U64Divisor& divisor);
+	template <uint16_t B> friend uint_t<B> pow_mod(const uint_t<B>& base, const uint_t<B>& exp, const uint_t<B>& mod);
+	template <uint16_t B> friend bool mul_mod(const uint_t<B>& a, const uint_t<B>& b, const uint_t<B>& mod,
+		typename non_deduced<uint_t<B>>::type* result);
+	template <uint16_t B> friend bool add_mod(const uint_t<B>& a, const uint_t<B>& b, const uint_t<B>& mod,
+		typename non_deduced<uint_t<B>>::type* result);
+	template <uint16_t B> friend bool sub_mod(const uint_t<B>& a, const uint_t<B>& b, const uint_t<B>& mod,
+		typename non_deduced<uint_t<B>>::type* result);
+	template <uint16_t B> friend bool sqr_mod(const uint_t<B>& a, const uint_t<B>& mod, typename non_deduced<uint_t<B>>::type* result);
 
 };
 
+// --- aliases ---
+
+using uint256 = uint_t<256u>;
+using uint512 = uint_t<512u>;
+using uint1024 = uint_t<1024u>;
+using uint1536 = uint_t<1536u>;
+using uint2048 = uint_t<2048u>;
+using uint3072 = uint_t<3072u>;
+using uint4096 = uint_t<4096u>;
+
+static_assert(std::is_trivially_copyable<uint2048>::value, "uint_t must stay trivially copyable");
+
 // --- static functions ---
 
+/*
+the functions below write their results through pointers to uint_ts the
+caller owns instead of returning new ones, so a loop can keep reusing the
+same objects. unless said otherwise, an output may point at any of the
+inputs: every input is read in full before the output is written.
+*/
+
+/*
+mul
+
+sets result to a * b, keeping the low Bits bits like operator*
+*/
+template <uint16_t Bits>
+void mul(const uint_t<Bits>& a, const uint_t<Bits>& b, typename non_deduced<uint_t<Bits>>::type* result);
+
+/*
+sqr
+
+sets result to a * a, keeping the low Bits bits.
+a square only needs the cross products a[i] * a[j] once, so it is
+cheaper than mul(a, a, result)
+*/
+template <uint16_t Bits>
+void sqr(const uint_t<Bits>& a, typename non_deduced<uint_t<Bits>>::type* result);
+
+/*
+mul_add
+
+sets result to a * b + c, keeping the low Bits bits.
+the product is not cut down before c is added
+*/
+template <uint16_t Bits>
+void mul_add(const uint_t<Bits>& a, const uint_t<Bits>& b, const uint_t<Bits>& c,
+	typename non_deduced<uint_t<Bits>>::type* result);
+
+/*
+divmod
+
+divides dividend by divisor with word level long division and hands back
+both results of the one division.
+quotient and remainder may be nullptr when that result is not needed, and
+may point at dividend or divisor, but not at the same uint_t.
+returns false and leaves both outputs untouched if divisor is zero.
+*/
+template <uint16_t Bits>
+bool divmod(const uint_t<Bits>& dividend, const uint_t<Bits>& divisor,
+	typename non_deduced<uint_t<Bits>>::type* quotient, typename non_deduced<uint_t<Bits>>::type* remainder);
+
+/*
+mod_u64
+
+returns num % divisor in one pass over the live limbs of num.
+the U64Divisor form skips computing the reciprocal, use it for divisors
+that are known ahead of time.
+throws std::domain_error if divisor is zero.
+*/
+template <uint16_t Bits>
+uint64_t mod_u64(const uint_t<Bits>& num, uint64_t divisor);
+
+template <uint16_t Bits>
+uint64_t mod_u64(const uint_t<Bits>& num, const U64Divisor& divisor);
+
+/*
+mul_mod, add_mod, sub_mod
+
+set result to a * b, a + b and a - b mod 'mod'.
+each one is a single pass of limb kernels into buffers on the stack with
+no uint_t temporaries in between, use them in place of (a * b) % mod and
+the like. mul_mod keeps the full double width product, so unlike
+(a * b) % mod it does not lose the bits above Bits.
+add_mod and sub_mod are cheapest with a and b already less than mod,
+otherwise they are reduced first.
+result may point at a, b or mod.
+all three return false and leave result untouched if mod is zero.
+*/
+template <uint16_t Bits>
+bool mul_mod(const uint_t<Bits>& a, const uint_t<Bits>& b, const uint_t<Bits>& mod,
+	typename non_deduced<uint_t<Bits>>::type* result);
+
+template <uint16_t Bits>
+bool add_mod(const uint_t<Bits>& a, const uint_t<Bits>& b, const uint_t<Bits>& mod,
+	typename non_deduced<uint_t<Bits>>::type* result);
+
+template <uint16_t Bits>
+bool sub_mod(const uint_t<Bits>& a, const uint_t<Bits>& b, const uint_t<Bits>& mod,
+	typename non_deduced<uint_t<Bits>>::type* result);
+
+/*
+sqr_mod
+
+sets result to a * a mod 'mod', the same as mul_mod(a, a, mod, result)
+with the cheaper square.
+result may point at a or mod.
+returns false and leaves result untouched if mod is zero.
+*/
+template <uint16_t Bits>
+bool sqr_mod(const uint_t<Bits>& a, const uint_t<Bits>& mod, typename non_deduced<uint_t<Bits>>::type* result);
+
+/*
+fill_random
+
+sets the 'count' uint_ts at nums to random numbers of exactly 'num_bits'
+bits, the same as calling Random(num_bits, gen) for each but written in
+place. only the limbs each one used before are cleared.
+*/
+template <uint16_t Bits, typename URBG>
+void fill_random(uint_t<Bits>* nums, size_t count, uint16_t num_bits, URBG* gen){
+	for (size_t i = 0u; i < count; ++i) nums[i].assign_random(num_bits, true, gen);
+}
+
+/*
+pow_mod
+
+returns base^exp mod 'mod'.
+left to right sliding window exponentiation: a table of the odd powers
+base^1, base^3, ... base^(2^w - 1) is built first, then every run of up to
+w exponent bits costs one table multiply. w is picked from exp.num_bits().
+odd moduli are multiplied in montgomery form, even ones are reduced with
+a BarrettContext.
+throws std::domain_error if mod is zero.
+*/
+template <uint16_t Bits>
+uint_t<Bits> pow_mod(const uint_t<Bits>& base, const uint_t<Bits>& exp, const uint_t<Bits>& mod);
+
+/*
+same as above, for callers that already hold a context for the modulus.
+base does not have to be reduced
+*/
+template <uint16_t Bits>
+uint_t<Bits> pow_mod(const uint_t<Bits>& base, const uint_t<Bits>& exp, const MontgomeryContext<Bits>& ctx);
+template <uint16_t Bits>
+uint_t<Bits> pow_mod(const uint_t<Bits>& base, const uint_t<Bits>& exp, const BarrettContext<Bits>& ctx);
+
 /*
 gcd_mod
 
-finds the greatest common divisor of two uint2048s.
+finds the greatest common divisor of two uint_ts.
 uses the Euclidean Algorithm with modulus.
 */
-uint2048 gcd_mod(const uint2048& a, const uint2048& b);
+template <uint16_t Bits>
+uint_t<Bits> gcd_mod(const uint_t<Bits>& a, const uint_t<Bits>& b);
 
 /*
 gcd_sub
 
-finds the greatest common divisor of two uint2048s.
+finds the greatest common divisor of two uint_ts.
 uses the Euclidean Algorithm with subtraction.
 */
-uint2048 gcd_sub(const uint2048& a, const uint2048& b);
+template <uint16_t Bits>
+uint_t<Bits> gcd_sub(const uint_t<Bits>& a, const uint_t<Bits>& b);
+
+/*
+gcd_binary
+
+finds the greatest common divisor of two uint_ts.
+uses Stein's binary algorithm: common factors of 2 are counted with
+trailing_zeros, then the smaller odd number is subtracted from the larger
+one and the zeros shifted out, so there is no division at all.
+*/
+template <uint16_t Bits>
+uint_t<Bits> gcd_binary(const uint_t<Bits>& a, const uint_t<Bits>& b);
+
+/*
+gcd_lehmer
+
+finds the greatest common divisor of two uint_ts.
+uses Lehmer's algorithm (knuth, TAOCP vol 2, 4.5.2 algorithm L): euclid's
+algorithm is run on the leading 62 bits of both numbers for as long as its
+quotients are certain to be the right ones, then the steps found are
+applied to the full numbers at once with single limb multiplies.
+*/
+template <uint16_t Bits>
+uint_t<Bits> gcd_lehmer(const uint_t<Bits>& a, const uint_t<Bits>& b);
+
+/*
+ext_gcd
+
+returns g = gcd(a, b) and sets x and y so that a * x - b * y = g,
+with 1 <= x <= b / g and 0 <= y < a / g when b is not zero.
+the coefficients are found with the same steps as gcd_lehmer.
+if b is 0, x = 1 and y = 0. if a is 0 there are no such x and y, both are
+set to 0. x and y may be nullptr.
+*/
+template <uint16_t Bits>
+uint_t<Bits> ext_gcd(const uint_t<Bits>& a, const uint_t<Bits>& b,
+	typename non_deduced<uint_t<Bits>>::type* x, typename non_deduced<uint_t<Bits>>::type* y);
+
+/*
+mod_inverse
+
+sets inverse to the number in [0, m) with a * inverse = 1 mod m.
+returns false and leaves inverse untouched if there is none,
+that is if gcd(a, m) != 1 or m is 0.
+*/
+template <uint16_t Bits>
+bool mod_inverse(const uint_t<Bits>& a, const uint_t<Bits>& m, typename non_deduced<uint_t<Bits>>::type* inverse);
+
+/*
+isqrt
+
+returns floor(sqrt(num)), with newton's iteration from a first guess that
+is already above the root, so every step goes down until it stops.
+*/
+template <uint16_t Bits>
+uint_t<Bits> isqrt(const uint_t<Bits>& num);
+
+/*
+is_square
+
+true if num is a perfect square.
+the residues of num mod 64, 63, 65 and 11 rule out all but about 1 in 150
+non squares with one single limb pass over num, only the rest go through
+isqrt.
+*/
+template <uint16_t Bits>
+bool is_square(const uint_t<Bits>& num);
+
+/*
+jacobi
+
+returns the jacobi symbol (a / n), -1, 0 or 1.
+binary algorithm: factors of 2 are shifted out of a and quadratic
+reciprocity swaps a and n, the same steps as gcd_binary with a sign that
+flips along the way. once n fits in one limb the rest is plain 64 bit
+arithmetic.
+the int64_t form is for small a of either sign, it costs one pass over n.
+n must be odd, throws std::invalid_argument otherwise.
+*/
+template <uint16_t Bits>
+int jacobi(const uint_t<Bits>& a, const uint_t<Bits>& n);
+
+template <uint16_t Bits>
+int jacobi(int64_t a, const uint_t<Bits>& n);